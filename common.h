@@ -60,6 +60,9 @@ void bailout(
 
 #define MASTER_RANK 0
 
+/*! First word of the index file of a restart written as subfiles, see writeRestart.*/
+#define SUBFILE_INDEX_TAG "VLSV_SUBFILES"
+
 /*! A namespace for storing indices into an array which contains 
  * neighbour list for each spatial cell. These indices refer to 
  * the CPU memory, i.e. the device does not use these.
@@ -222,8 +225,11 @@ namespace CellParams {
       ISCELLSAVINGF,      /*!< Value telling whether a cell is saving its distribution function when partial f data is written out. */
       PHI,        /*!< Electrostatic potential.*/
       PHI_TMP,    /*!< Temporary electrostatic potential.*/
+      PHI_OLD1,   /*!< Electrostatic potential of the previous Poisson solve, used for extrapolating the initial guess.*/
+      PHI_OLD2,   /*!< Electrostatic potential of the second previous Poisson solve.*/
       RHOQ_TOT,   /*!< Total charge density, summed over all particle populations.*/
       RHOQ_EXT,   /*<! External charge density.*/
+      RHOQ,       /*!< Charge density of particle populations, calculated together with the latest velocity moments.*/
       BGEXVOL,    /*!< Background electric field averaged over spatial cell, x-component.*/
       BGEYVOL,    /*!< Background electric field averaged over spatial cell, y-component.*/
       BGEZVOL,    /*!< Background electric field averaged over spatial cell, z-component.*/
@@ -26,6 +26,7 @@
 #include "derivatives.hpp"
 #include "fs_limiters.h"
 #include "fs_cache.h"
+#include "../mpi_progress.h"
 
 extern map<CellID,uint> existingCellsFlags; /**< Defined in fs_common.cpp */
 
@@ -382,6 +383,52 @@ void calculateDerivatives(
 }
 
 
+/*! \brief Low-level spatial derivatives boundary conditions.
+ * 
+ * Applies the derivative boundary conditions on system boundary cells beyond the first 
+ * boundary layer. This is what calculateDerivatives does for these cells, but the cells 
+ * are processed one boundary type at a time so the boundary condition is looked up only once.
+ * \param mpiGrid Grid
+ * \param cellCache Field solver cell cache
+ * \param sysBoundaryCells Local IDs of system boundary cells grouped by sysBoundaryFlag
+ * \param sysBoundaries System boundary conditions existing
+ * \param RKCase Element in the enum defining the Runge-Kutta method steps
+ * 
+ * \sa calculateDerivatives calculateDerivativesSimple
+ */
+void calculateSysBoundaryDerivatives(
+   dccrg::Dccrg<spatial_cell::SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+   std::vector<fs_cache::CellCache>& cellCache,
+   const map<uint,vector<uint16_t> >& sysBoundaryCells,
+   SysBoundary& sysBoundaries,
+   cint& RKCase
+) {
+   namespace fs = fieldsolver;
+
+   for (map<uint,vector<uint16_t> >::const_iterator it=sysBoundaryCells.begin(); it!=sysBoundaryCells.end(); ++it) {
+      SBC::SysBoundaryCondition* sysBoundary = sysBoundaries.getSysBoundary(it->first);
+      const vector<uint16_t>& cells = it->second;
+
+      for (size_t c=0; c<cells.size(); ++c) {
+         const CellID cellID = cellCache[cells[c]].cellID;
+         for (uint component=0; component<3; ++component) {
+            sysBoundary->fieldSolverBoundaryCondDerivatives(mpiGrid, cellID, RKCase, component);
+         }
+
+         if (Parameters::ohmHallTerm < 2) {
+            Real* const array = cellCache[cells[c]].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
+            array[fs::dPERBxdyz] = 0.0;
+            array[fs::dPERBydxz] = 0.0;
+            array[fs::dPERBzdxy] = 0.0;
+         } else {
+            for (uint component=3; component<6; ++component) {
+               sysBoundary->fieldSolverBoundaryCondDerivatives(mpiGrid, cellID, RKCase, component);
+            }
+         }
+      }
+   }
+}
+
 /*! \brief High-level derivative calculation wrapper function.
  * 
 
@@ -439,35 +486,37 @@ void calculateDerivativesSimple(
    phiprof::start(timer);
    mpiGrid.start_remote_neighbor_copy_updates(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::exchangeStarted();
 
    timer=phiprof::initializeTimer("Compute process inner cells");
    phiprof::start(timer);
 
    // Calculate derivatives on process inner cells
-   for (size_t c=0; c<fs_cache::getCache().cellsWithLocalNeighbours.size(); ++c) {
-      const uint16_t localID = fs_cache::getCache().cellsWithLocalNeighbours[c];
-      fs_cache::CellCache cache = fs_cache::getCache().localCellsCache[localID];
-
-      if (cache.sysBoundaryFlag == sysboundarytype::DO_NOT_COMPUTE) continue;
-      calculateDerivatives(mpiGrid,cache,sysBoundaries, RKCase, doMoments);
+   const fs_cache::SplitCellList& innerCells = fs_cache::getCache().splitCellsWithLocalNeighbours;
+   for (size_t c=0; c<innerCells.solverCells.size(); ++c) {
+      const uint16_t localID = innerCells.solverCells[c];
+      calculateDerivatives(mpiGrid,fs_cache::getCache().localCellsCache[localID],sysBoundaries, RKCase, doMoments);
+      mpiprogress::poll();
    }
+   calculateSysBoundaryDerivatives(mpiGrid,fs_cache::getCache().localCellsCache,innerCells.sysBoundaryCells,sysBoundaries,RKCase);
    phiprof::stop(timer,fs_cache::getCache().cellsWithLocalNeighbours.size(),"Spatial Cells");
 
+   mpiprogress::waitStarted();
    timer=phiprof::initializeTimer("Wait for sends","MPI","Wait");
    phiprof::start(timer);
    mpiGrid.wait_remote_neighbor_copy_update_receives(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::waitFinished();
    
    // Calculate derivatives on process boundary cells
    timer=phiprof::initializeTimer("Compute process boundary cells");
    phiprof::start(timer);
-   for (size_t c=0; c<fs_cache::getCache().cellsWithRemoteNeighbours.size(); ++c) {
-      const uint16_t localID = fs_cache::getCache().cellsWithRemoteNeighbours[c];
-      fs_cache::CellCache cache = fs_cache::getCache().localCellsCache[localID];
-
-      if (cache.sysBoundaryFlag == sysboundarytype::DO_NOT_COMPUTE) continue;
-      calculateDerivatives(mpiGrid,cache,sysBoundaries, RKCase, doMoments);
+   const fs_cache::SplitCellList& boundaryCells = fs_cache::getCache().splitCellsWithRemoteNeighbours;
+   for (size_t c=0; c<boundaryCells.solverCells.size(); ++c) {
+      const uint16_t localID = boundaryCells.solverCells[c];
+      calculateDerivatives(mpiGrid,fs_cache::getCache().localCellsCache[localID],sysBoundaries, RKCase, doMoments);
    }
+   calculateSysBoundaryDerivatives(mpiGrid,fs_cache::getCache().localCellsCache,boundaryCells.sysBoundaryCells,sysBoundaries,RKCase);
    phiprof::stop(timer,fs_cache::getCache().cellsWithRemoteNeighbours.size(),"Spatial Cells");
 
    timer=phiprof::initializeTimer("Wait for sends","MPI","Wait");
@@ -598,6 +647,7 @@ void calculateBVOLDerivativesSimple(
    phiprof::start(timer);
    mpiGrid.start_remote_neighbor_copy_updates(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::exchangeStarted();
 
    // Calculate derivatives on process inner cells
    timer=phiprof::initializeTimer("Compute process inner cells");
@@ -605,10 +655,12 @@ void calculateBVOLDerivativesSimple(
    calculateBVOLDerivatives(mpiGrid,fs_cache::getCache().localCellsCache,fs_cache::getCache().cellsWithLocalNeighbours,sysBoundaries);
    phiprof::stop(timer,fs_cache::getCache().cellsWithLocalNeighbours.size(),"Spatial Cells");
 
+   mpiprogress::waitStarted();
    timer=phiprof::initializeTimer("Wait for sends","MPI","Wait");
    phiprof::start(timer);
    mpiGrid.wait_remote_neighbor_copy_update_receives(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::waitFinished();
 
    // Calculate derivatives on process boundary cells
    timer=phiprof::initializeTimer("Compute process boundary cells");
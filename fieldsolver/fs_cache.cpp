@@ -42,6 +42,9 @@ vector<uint16_t> fs_cache::CacheContainer::cellsWithLocalNeighbours;
 vector<uint16_t> fs_cache::CacheContainer::cellsWithRemoteNeighbours;
 vector<uint16_t> fs_cache::CacheContainer::local_NOT_DO_NOT_COMPUTE;
 vector<uint16_t> fs_cache::CacheContainer::local_NOT_SYSBOUND_DO_NOT_COMPUTE;
+fs_cache::SplitCellList fs_cache::CacheContainer::splitCellsWithLocalNeighbours;
+fs_cache::SplitCellList fs_cache::CacheContainer::splitCellsWithRemoteNeighbours;
+fs_cache::SplitCellList fs_cache::CacheContainer::split_local_NOT_DO_NOT_COMPUTE;
 
 namespace fs_cache {
            
@@ -133,8 +136,56 @@ namespace fs_cache {
          cacheContainer.cellsWithRemoteNeighbours.push_back(globalToLocalMap[cellsWithRemoteNeighbours[c]]);
       }
 
+      // Split the lists into solver cells and system boundary cells of each type
+      splitCellList(cacheContainer.localCellsCache,cacheContainer.cellsWithLocalNeighbours,
+                    cacheContainer.splitCellsWithLocalNeighbours);
+      splitCellList(cacheContainer.localCellsCache,cacheContainer.cellsWithRemoteNeighbours,
+                    cacheContainer.splitCellsWithRemoteNeighbours);
+      splitCellList(cacheContainer.localCellsCache,cacheContainer.local_NOT_DO_NOT_COMPUTE,
+                    cacheContainer.split_local_NOT_DO_NOT_COMPUTE);
+
       cacheContainer.cacheCalculatedStep = Parameters::tstep;
    }
+
+   /** Split the given cells into cells updated by the field solver kernels 
+    * (not system boundary cells, or first system boundary layer) and into 
+    * system boundary cells grouped by their sysBoundaryFlag. DO_NOT_COMPUTE 
+    * cells are skipped.
+    * @param cellCache Field solver cell cache.
+    * @param cells Local IDs of the cells, indexing cellCache.
+    * @param split Container where the split lists are written.*/
+   void splitCellList(
+      const std::vector<fs_cache::CellCache>& cellCache,
+      const std::vector<uint16_t>& cells,
+      SplitCellList& split
+   ) {
+      split.clear();
+      for (size_t c=0; c<cells.size(); ++c) {
+         const uint16_t localID = cells[c];
+         cuint sysBoundaryFlag  = cellCache[localID].sysBoundaryFlag;
+         cuint sysBoundaryLayer = cellCache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->sysBoundaryLayer;
+
+         if (sysBoundaryFlag == sysboundarytype::DO_NOT_COMPUTE) continue;
+         if (sysBoundaryFlag == sysboundarytype::NOT_SYSBOUNDARY || sysBoundaryLayer == 1) {
+            split.solverCells.push_back(localID);
+         } else {
+            split.sysBoundaryCells[sysBoundaryFlag].push_back(localID);
+         }
+      }
+   }
+
+   void SplitCellList::clear() {
+      vector<uint16_t>().swap(solverCells);
+      sysBoundaryCells.clear();
+   }
+
+   size_t SplitCellList::size() const {
+      size_t N = solverCells.size();
+      for (map<uint,vector<uint16_t> >::const_iterator it=sysBoundaryCells.begin(); it!=sysBoundaryCells.end(); ++it) {
+         N += it->second.size();
+      }
+      return N;
+   }
    
    void CacheContainer::clear() {
       vector<fs_cache::CellCache>().swap(localCellsCache);
@@ -144,6 +195,9 @@ namespace fs_cache {
       vector<uint16_t>().swap(boundaryCellsWithRemoteNeighbours);
       vector<uint16_t>().swap(cellsWithRemoteNeighbours);
       vector<uint16_t>().swap(cellsWithLocalNeighbours);
+      splitCellsWithLocalNeighbours.clear();
+      splitCellsWithRemoteNeighbours.clear();
+      split_local_NOT_DO_NOT_COMPUTE.clear();
    }
    
    CacheContainer& getCache() {return cacheContainer;}
@@ -23,6 +23,7 @@
 #ifndef FS_CACHE_H
 #define FS_CACHE_H
 
+#include <map>
 #include <vector>
 
 #include <dccrg.hpp>
@@ -70,6 +71,18 @@ namespace fs_cache {
       spatial_cell::SpatialCell* cells[27];
    };
    
+   /** Cells of one of the CacheContainer cell lists, split by the kind of update 
+    * they need so that the field solver kernels can process them without 
+    * per-cell system boundary checks.*/
+   struct SplitCellList {
+      std::vector<uint16_t> solverCells;                       /**< Cells that are not system boundary cells, or are in the first 
+                                                                * system boundary layer. Updated by the field solver kernels.*/
+      std::map<uint,std::vector<uint16_t> > sysBoundaryCells;  /**< Remaining system boundary cells grouped by sysBoundaryFlag. 
+                                                                * Updated by the system boundary conditions, one type at a time.*/
+      void clear();
+      size_t size() const;
+   };
+
    struct CacheContainer {
       static long int cacheCalculatedStep;
       static std::vector<fs_cache::CellCache> localCellsCache;        /**< Cache for all local cells.*/
@@ -84,6 +97,9 @@ namespace fs_cache {
                                                                        * Stored values are used to index CacheContainer::localCellsCache.*/
       static std::vector<uint16_t> local_NOT_DO_NOT_COMPUTE;          /**< Exclude DO_NOT_COMPUTE cells.*/
       static std::vector<uint16_t> local_NOT_SYSBOUND_DO_NOT_COMPUTE; /**< Exclude DO_NOT_COMPUTE and system boundary cells.*/
+      static SplitCellList splitCellsWithLocalNeighbours;             /**< cellsWithLocalNeighbours split into solver and system boundary cells.*/
+      static SplitCellList splitCellsWithRemoteNeighbours;            /**< cellsWithRemoteNeighbours split into solver and system boundary cells.*/
+      static SplitCellList split_local_NOT_DO_NOT_COMPUTE;            /**< local_NOT_DO_NOT_COMPUTE split into solver and system boundary cells.*/
       
       static void clear();
    };
@@ -95,6 +111,12 @@ namespace fs_cache {
    
    CacheContainer& getCache();
 
+   void splitCellList(
+      const std::vector<fs_cache::CellCache>& cellCache,
+      const std::vector<uint16_t>& cells,
+      SplitCellList& split
+   );
+
 } // namespace fs_cache
    
 #endif
@@ -25,6 +25,7 @@
 #include "fs_common.h"
 #include "fs_cache.h"
 #include "ldz_electric_field.hpp"
+#include "../mpi_progress.h"
 
 #ifndef NDEBUG
    #define DEBUG_FSOLVER
@@ -1378,11 +1379,13 @@ void calculateEdgeElectricFieldZ(
 
 /*! \brief Electric field propagation function.
  * 
- * Calls the general or the system boundary electric field propagation functions.
+ * Calls the general electric field propagation functions on the solver cells, 
+ * and then the system boundary electric field functions on the system boundary 
+ * cells, one boundary type at a time.
  * 
  * \param mpiGrid Grid
  * \param cellCache Field solver cell cache
- * \param cells Vector of cells to process
+ * \param cells Cells to process, split into solver and system boundary cells
  * \param sysBoundaries System boundary conditions existing
  * \param RKCase Element in the enum defining the Runge-Kutta method steps
  * 
@@ -1392,55 +1395,45 @@ void calculateEdgeElectricFieldZ(
 void calculateElectricField(
    dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    std::vector<fs_cache::CellCache>& cellCache,
-   const std::vector<uint16_t>& cells,
+   const fs_cache::SplitCellList& cells,
    SysBoundary& sysBoundaries,
    cint& RKCase
 ) {
+   // Solver cells, no system boundary condition checks needed. Cells at the 
+   // edge of the simulation domain may lack the neighbours of some edges.
+   const std::vector<uint16_t>& solverCells = cells.solverCells;
    #pragma omp parallel for
-   for (size_t c=0; c<cells.size(); ++c) {
-      const uint16_t localID = cells[c];
-      fs_cache::CellCache& cache = cellCache[localID];
-      const CellID cellID = cache.cellID;
+   for (size_t c=0; c<solverCells.size(); ++c) {
+      fs_cache::CellCache& cache = cellCache[solverCells[c]];
+      cuint fieldSolverSysBoundaryFlag = cache.existingCellsFlags;
 
-      if (cache.sysBoundaryFlag == sysboundarytype::DO_NOT_COMPUTE) continue;
+      if ((fieldSolverSysBoundaryFlag & CALCULATE_EX) == CALCULATE_EX) calculateEdgeElectricFieldX(cache,RKCase);
+      if ((fieldSolverSysBoundaryFlag & CALCULATE_EY) == CALCULATE_EY) calculateEdgeElectricFieldY(cache,RKCase);
+      if ((fieldSolverSysBoundaryFlag & CALCULATE_EZ) == CALCULATE_EZ) calculateEdgeElectricFieldZ(cache,RKCase);
+      mpiprogress::poll();
+   }
 
-      cuint fieldSolverSysBoundaryFlag = cache.existingCellsFlags;
-      cuint cellSysBoundaryFlag        = cache.sysBoundaryFlag;
-      cuint cellSysBoundaryLayer       = cache.cells[fs_cache::calculateNbrID(1,1,1)]->sysBoundaryLayer;
-
-      if ((fieldSolverSysBoundaryFlag & CALCULATE_EX) == CALCULATE_EX) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-             (cellSysBoundaryLayer != 1)
-            ) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->
-              fieldSolverBoundaryCondElectricField(mpiGrid, cellID, RKCase, 0);
-         } else {
-            calculateEdgeElectricFieldX(cache,RKCase);
-         }
-      }
+   // System boundary cells, one boundary type at a time
+   for (map<uint,vector<uint16_t> >::const_iterator it=cells.sysBoundaryCells.begin(); it!=cells.sysBoundaryCells.end(); ++it) {
+      SBC::SysBoundaryCondition* sysBoundary = sysBoundaries.getSysBoundary(it->first);
+      const std::vector<uint16_t>& boundaryCells = it->second;
 
-      if ((fieldSolverSysBoundaryFlag & CALCULATE_EY) == CALCULATE_EY) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-            (cellSysBoundaryLayer != 1)
-           ) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->
-              fieldSolverBoundaryCondElectricField(mpiGrid, cellID, RKCase, 1);
-         } else {
-            calculateEdgeElectricFieldY(cache,RKCase);
-         }
-      }
+      #pragma omp parallel for
+      for (size_t c=0; c<boundaryCells.size(); ++c) {
+         const fs_cache::CellCache& cache = cellCache[boundaryCells[c]];
+         cuint fieldSolverSysBoundaryFlag = cache.existingCellsFlags;
 
-      if ((fieldSolverSysBoundaryFlag & CALCULATE_EZ) == CALCULATE_EZ) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-            (cellSysBoundaryLayer != 1)
-           ) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->
-              fieldSolverBoundaryCondElectricField(mpiGrid, cellID, RKCase, 2);
-         } else {
-            calculateEdgeElectricFieldZ(cache,RKCase);
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EX) == CALCULATE_EX) {
+            sysBoundary->fieldSolverBoundaryCondElectricField(mpiGrid, cache.cellID, RKCase, 0);
+         }
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EY) == CALCULATE_EY) {
+            sysBoundary->fieldSolverBoundaryCondElectricField(mpiGrid, cache.cellID, RKCase, 1);
+         }
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EZ) == CALCULATE_EZ) {
+            sysBoundary->fieldSolverBoundaryCondElectricField(mpiGrid, cache.cellID, RKCase, 2);
          }
       }
-   } // for-loop over spatial cells
+   }
 }
 
 /*! \brief High-level electric field computation function.
@@ -1479,25 +1472,28 @@ void calculateUpwindedElectricFieldSimple(
    phiprof::start(timer);
    mpiGrid.start_remote_neighbor_copy_updates(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::exchangeStarted();
    
    // Calculate upwinded electric field on inner cells
    timer=phiprof::initializeTimer("Compute inner cells");
    phiprof::start(timer);
    calculateElectricField(mpiGrid,fs_cache::getCache().localCellsCache,
-                          fs_cache::getCache().cellsWithLocalNeighbours,
+                          fs_cache::getCache().splitCellsWithLocalNeighbours,
                           sysBoundaries,RKCase);
    phiprof::stop(timer,fs_cache::getCache().cellsWithLocalNeighbours.size(),"Spatial Cells");
    
+   mpiprogress::waitStarted();
    timer=phiprof::initializeTimer("Wait for receives","MPI","Wait");
    phiprof::start(timer);
    mpiGrid.wait_remote_neighbor_copy_update_receives(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::waitFinished();
 
    // Calculate upwinded electric field on boundary cells:
    timer=phiprof::initializeTimer("Compute boundary cells");
    phiprof::start(timer);
    calculateElectricField(mpiGrid,fs_cache::getCache().localCellsCache,   
-                          fs_cache::getCache().cellsWithRemoteNeighbours,
+                          fs_cache::getCache().splitCellsWithRemoteNeighbours,
                           sysBoundaries,RKCase);
    phiprof::stop(timer,fs_cache::getCache().cellsWithRemoteNeighbours.size(),"Spatial Cells");
 
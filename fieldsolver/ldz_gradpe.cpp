@@ -23,6 +23,7 @@
 #include "fs_common.h"
 #include "fs_cache.h"
 #include "ldz_gradpe.hpp"
+#include "../mpi_progress.h"
 
 #ifndef NDEBUG
    #define DEBUG_FSOLVER
@@ -262,20 +263,23 @@ void calculateEdgeGradPeTermZComponents(
 }
 
 /** Calculate the electron pressure gradient term on all given cells.
+ * Solver cells are computed with the gradient kernels, system boundary 
+ * cells with the boundary conditions, one boundary type at a time.
  * @param sysBoundaries System boundary condition functions.
  * @param cache Cache for local cells.
- * @param cells Local IDs of calculated cells, one of the vectors in fs_cache::CacheContainer.
+ * @param cells Calculated cells, one of the split lists in fs_cache::CacheContainer.
  * @param RKCase
  */
 void calculateGradPeTerm(
    SysBoundary& sysBoundaries,
    std::vector<fs_cache::CellCache>& cache,
-   const std::vector<uint16_t>& cells,
+   const fs_cache::SplitCellList& cells,
    cint& RKCase
 ) {
+   const std::vector<uint16_t>& solverCells = cells.solverCells;
    #pragma omp parallel for
-   for (size_t c=0; c<cells.size(); ++c) { // DO_NOT_COMPUTE cells already removed
-      const uint16_t localID = cells[c];
+   for (size_t c=0; c<solverCells.size(); ++c) { // DO_NOT_COMPUTE cells already removed
+      const uint16_t localID = solverCells[c];
 
       #ifdef DEBUG_FSOLVER
       if (localID >= cache.size()) {
@@ -296,40 +300,38 @@ void calculateGradPeTerm(
       }
       #endif
 
+      Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
+      Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
       cuint fieldSolverSysBoundaryFlag = cache[localID].existingCellsFlags;
-      cuint cellSysBoundaryFlag        = cache[localID].sysBoundaryFlag;
-      cuint cellSysBoundaryLayer       = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->sysBoundaryLayer;
-
-      Real perturbedCoefficients[Rec::N_REC_COEFFICIENTS];
-
       if ((fieldSolverSysBoundaryFlag & CALCULATE_EX) == CALCULATE_EX) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-             (cellSysBoundaryLayer != 1)) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->fieldSolverBoundaryCondGradPeElectricField(cache[localID],RKCase,0);
-         } else {
-            Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
-            Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
-            calculateEdgeGradPeTermXComponents(cp,derivs,RKCase);
-         }
+         calculateEdgeGradPeTermXComponents(cp,derivs,RKCase);
       }
       if ((fieldSolverSysBoundaryFlag & CALCULATE_EY) == CALCULATE_EY) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-             (cellSysBoundaryLayer != 1)) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->fieldSolverBoundaryCondGradPeElectricField(cache[localID],RKCase,1);
-         } else {
-            Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
-            Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
-            calculateEdgeGradPeTermYComponents(cp,derivs,RKCase);
-         }
+         calculateEdgeGradPeTermYComponents(cp,derivs,RKCase);
       }
       if ((fieldSolverSysBoundaryFlag & CALCULATE_EZ) == CALCULATE_EZ) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-             (cellSysBoundaryLayer != 1)) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->fieldSolverBoundaryCondGradPeElectricField(cache[localID],RKCase,2);
-         } else {
-            Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
-            Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
-            calculateEdgeGradPeTermZComponents(cp,derivs,RKCase);
+         calculateEdgeGradPeTermZComponents(cp,derivs,RKCase);
+      }
+      mpiprogress::poll();
+   }
+
+   for (map<uint,vector<uint16_t> >::const_iterator it=cells.sysBoundaryCells.begin(); it!=cells.sysBoundaryCells.end(); ++it) {
+      SBC::SysBoundaryCondition* sysBoundary = sysBoundaries.getSysBoundary(it->first);
+      const std::vector<uint16_t>& boundaryCells = it->second;
+
+      #pragma omp parallel for
+      for (size_t c=0; c<boundaryCells.size(); ++c) {
+         const uint16_t localID = boundaryCells[c];
+         cuint fieldSolverSysBoundaryFlag = cache[localID].existingCellsFlags;
+
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EX) == CALCULATE_EX) {
+            sysBoundary->fieldSolverBoundaryCondGradPeElectricField(cache[localID],RKCase,0);
+         }
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EY) == CALCULATE_EY) {
+            sysBoundary->fieldSolverBoundaryCondGradPeElectricField(cache[localID],RKCase,1);
+         }
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EZ) == CALCULATE_EZ) {
+            sysBoundary->fieldSolverBoundaryCondGradPeElectricField(cache[localID],RKCase,2);
          }
       }
    }
@@ -352,22 +354,25 @@ void calculateGradPeTermSimple(
    phiprof::start(timer);
    mpiGrid.start_remote_neighbor_copy_updates(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::exchangeStarted();
 
    // Calculate GradPe term on inner cells
    timer=phiprof::initializeTimer("Compute inner cells");
    phiprof::start(timer);
-   calculateGradPeTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.cellsWithLocalNeighbours,RKCase);
+   calculateGradPeTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.splitCellsWithLocalNeighbours,RKCase);
    phiprof::stop(timer,cacheContainer.cellsWithLocalNeighbours.size(),"Spatial Cells");
 
+   mpiprogress::waitStarted();
    timer=phiprof::initializeTimer("Wait for receives","MPI","Wait");
    phiprof::start(timer);
    mpiGrid.wait_remote_neighbor_copy_update_receives(FIELD_SOLVER_NEIGHBORHOOD_ID);
    phiprof::stop(timer);
+   mpiprogress::waitFinished();
    
    // Calculate GradPe term on boundary cells:
    timer=phiprof::initializeTimer("Compute boundary cells");
    phiprof::start(timer);
-   calculateGradPeTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.cellsWithRemoteNeighbours,RKCase);
+   calculateGradPeTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.splitCellsWithRemoteNeighbours,RKCase);
    phiprof::stop(timer,cacheContainer.cellsWithRemoteNeighbours.size(),"Spatial Cells");
 
    timer=phiprof::initializeTimer("Wait for sends","MPI","Wait");
@@ -43,7 +43,7 @@ void calculateEdgeGradPeTermZComponents(
 void calculateGradPeTerm(
    SysBoundary& sysBoundaries,
    std::vector<fs_cache::CellCache>& cache,
-   const std::vector<uint16_t>& cells,
+   const fs_cache::SplitCellList& cells,
    cint& RKCase
 );
 
@@ -23,6 +23,7 @@
 #include "fs_common.h"
 #include "fs_cache.h"
 #include "ldz_hall.hpp"
+#include "../mpi_progress.h"
 
 #ifndef NDEBUG
    #define DEBUG_FSOLVER
@@ -702,9 +703,12 @@ void calculateEdgeHallTermZComponents(
 }
 
 /** \brief Calculate the Hall term on all given cells.
+ * 
+ * Solver cells are computed with the Hall term kernels, system boundary 
+ * cells with the boundary conditions, one boundary type at a time.
  * \param sysBoundaries System boundary condition functions.
  * \param cache Cache for local cells.
- * \param cells Local IDs of calculated cells, one of the vectors in fs_cache::CacheContainer.
+ * \param cells Calculated cells, one of the split lists in fs_cache::CacheContainer.
  * \param RKCase Element in the enum defining the Runge-Kutta method steps
  * 
  * \sa calculateHallTermSimple calculateEdgeHallTermXComponents calculateEdgeHallTermYComponents calculateEdgeHallTermZComponents
@@ -712,13 +716,14 @@ void calculateEdgeHallTermZComponents(
 void calculateHallTerm(
    SysBoundary& sysBoundaries,
    std::vector<fs_cache::CellCache>& cache,
-   const std::vector<uint16_t>& cells,
+   const fs_cache::SplitCellList& cells,
    cint& RKCase
 ) {
 
+   const std::vector<uint16_t>& solverCells = cells.solverCells;
    #pragma omp parallel for
-   for (size_t c=0; c<cells.size(); ++c) { // DO_NOT_COMPUTE cells already removed
-      const uint16_t localID = cells[c];
+   for (size_t c=0; c<solverCells.size(); ++c) { // DO_NOT_COMPUTE cells already removed
+      const uint16_t localID = solverCells[c];
 
       #ifdef DEBUG_FSOLVER
       if (localID >= cache.size()) {
@@ -739,10 +744,6 @@ void calculateHallTerm(
       }
       #endif
 
-      cuint fieldSolverSysBoundaryFlag = cache[localID].existingCellsFlags;
-      cuint cellSysBoundaryFlag        = cache[localID].sysBoundaryFlag;
-      cuint cellSysBoundaryLayer       = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->sysBoundaryLayer;
-
       Real perturbedCoefficients[Rec::N_REC_COEFFICIENTS];
 
       reconstructionCoefficients(cache[localID],
@@ -751,34 +752,38 @@ void calculateHallTerm(
                                  RKCase
                                 );
 
+      Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
+      Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
+      cuint fieldSolverSysBoundaryFlag = cache[localID].existingCellsFlags;
       if ((fieldSolverSysBoundaryFlag & CALCULATE_EX) == CALCULATE_EX) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-             (cellSysBoundaryLayer != 1)) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->fieldSolverBoundaryCondHallElectricField(cache[localID],RKCase,0);
-         } else {
-            Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
-            Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
-            calculateEdgeHallTermXComponents(cp,derivs,perturbedCoefficients,RKCase);
-         }
+         calculateEdgeHallTermXComponents(cp,derivs,perturbedCoefficients,RKCase);
       }
       if ((fieldSolverSysBoundaryFlag & CALCULATE_EY) == CALCULATE_EY) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-             (cellSysBoundaryLayer != 1)) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->fieldSolverBoundaryCondHallElectricField(cache[localID],RKCase,1);
-         } else {
-            Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
-            Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
-            calculateEdgeHallTermYComponents(cp,derivs,perturbedCoefficients,RKCase);
-         }
+         calculateEdgeHallTermYComponents(cp,derivs,perturbedCoefficients,RKCase);
       }
       if ((fieldSolverSysBoundaryFlag & CALCULATE_EZ) == CALCULATE_EZ) {
-         if ((cellSysBoundaryFlag != sysboundarytype::NOT_SYSBOUNDARY) &&
-             (cellSysBoundaryLayer != 1)) {
-            sysBoundaries.getSysBoundary(cellSysBoundaryFlag)->fieldSolverBoundaryCondHallElectricField(cache[localID],RKCase,2);
-         } else {
-            Real* cp     = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->parameters;
-            Real* derivs = cache[localID].cells[fs_cache::calculateNbrID(1,1,1)]->derivatives;
-            calculateEdgeHallTermZComponents(cp,derivs,perturbedCoefficients,RKCase);
+         calculateEdgeHallTermZComponents(cp,derivs,perturbedCoefficients,RKCase);
+      }
+      mpiprogress::poll();
+   }
+
+   for (map<uint,vector<uint16_t> >::const_iterator it=cells.sysBoundaryCells.begin(); it!=cells.sysBoundaryCells.end(); ++it) {
+      SBC::SysBoundaryCondition* sysBoundary = sysBoundaries.getSysBoundary(it->first);
+      const std::vector<uint16_t>& boundaryCells = it->second;
+
+      #pragma omp parallel for
+      for (size_t c=0; c<boundaryCells.size(); ++c) {
+         const uint16_t localID = boundaryCells[c];
+         cuint fieldSolverSysBoundaryFlag = cache[localID].existingCellsFlags;
+
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EX) == CALCULATE_EX) {
+            sysBoundary->fieldSolverBoundaryCondHallElectricField(cache[localID],RKCase,0);
+         }
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EY) == CALCULATE_EY) {
+            sysBoundary->fieldSolverBoundaryCondHallElectricField(cache[localID],RKCase,1);
+         }
+         if ((fieldSolverSysBoundaryFlag & CALCULATE_EZ) == CALCULATE_EZ) {
+            sysBoundary->fieldSolverBoundaryCondHallElectricField(cache[localID],RKCase,2);
          }
       }
    }
@@ -816,22 +821,25 @@ void calculateHallTermSimple(
       phiprof::start(timer);
       mpiGrid.start_remote_neighbor_copy_updates(FIELD_SOLVER_NEIGHBORHOOD_ID);
       phiprof::stop(timer);
+      mpiprogress::exchangeStarted();
 
       // Calculate Hall term on inner cells
       timer=phiprof::initializeTimer("Compute inner cells");
       phiprof::start(timer);
-      calculateHallTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.cellsWithLocalNeighbours,RKCase);
+      calculateHallTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.splitCellsWithLocalNeighbours,RKCase);
       phiprof::stop(timer,cacheContainer.cellsWithLocalNeighbours.size(),"Spatial Cells");
 
+      mpiprogress::waitStarted();
       timer=phiprof::initializeTimer("Wait for receives","MPI","Wait");
       phiprof::start(timer);
       mpiGrid.wait_remote_neighbor_copy_update_receives(FIELD_SOLVER_NEIGHBORHOOD_ID);
       phiprof::stop(timer);
+      mpiprogress::waitFinished();
       
       // Calculate Hall term on boundary cells:
       timer=phiprof::initializeTimer("Compute boundary cells");
       phiprof::start(timer);
-      calculateHallTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.cellsWithRemoteNeighbours,RKCase);
+      calculateHallTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.splitCellsWithRemoteNeighbours,RKCase);
       phiprof::stop(timer,cacheContainer.cellsWithRemoteNeighbours.size(),"Spatial Cells");
 
       timer=phiprof::initializeTimer("Wait for sends","MPI","Wait");
@@ -843,7 +851,7 @@ void calculateHallTermSimple(
       + cacheContainer.cellsWithLocalNeighbours.size();
    } else {
       fs_cache::CacheContainer& cacheContainer = fs_cache::getCache();
-      calculateHallTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.local_NOT_DO_NOT_COMPUTE,RKCase);
+      calculateHallTerm(sysBoundaries,cacheContainer.localCellsCache,cacheContainer.split_local_NOT_DO_NOT_COMPUTE,RKCase);
       N_cells = cacheContainer.local_NOT_DO_NOT_COMPUTE.size();
    }
 
@@ -45,7 +45,7 @@ void calculateEdgeHallTermZComponents(
 void calculateHallTerm(
    SysBoundary& sysBoundaries,
    std::vector<fs_cache::CellCache>& cache,
-   const std::vector<uint16_t>& cells,
+   const fs_cache::SplitCellList& cells,
    cint& RKCase
 );
 
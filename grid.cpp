@@ -42,6 +42,7 @@
 #include "iowrite.h"
 #include "ioread.h"
 #include "object_wrapper.h"
+#include "mpi_progress.h"
 
 #ifdef PAPI_MEM
 #include "papi.h" 
@@ -447,6 +448,162 @@ void balanceLoad(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid, S
    phiprof::stop("Balancing load");
 }
 
+/*! Scale the distribution function in the given cell so that the mass removed 
+ * together with velocity blocks is returned to the remaining blocks. The 
+ * remaining mass is summed up in the same units as CellParams::RHOLOSSADJUST.
+ * \param cell Spatial cell.
+ * \param popID Particle population ID.
+ * \param removedMass Mass (density) removed from the cell when blocks were deleted.
+ */
+void rescaleVelocityBlocksToConserveMass(SpatialCell* cell,const int& popID,const Real& removedMass) {
+   const vmesh::LocalID nBlocks = cell->get_number_of_velocity_blocks(popID);
+   const Real* blockParams = cell->get_block_parameters(popID);
+   Realf* data = cell->get_data(popID);
+
+   Real remainingMass = 0.0;
+   for (vmesh::LocalID blockLID=0; blockLID<nBlocks; ++blockLID) {
+      const Real* params = blockParams + blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS;
+      const Realf* blockData = data + blockLID*WID3;
+      Real sum = 0.0;
+      for (uint i=0; i<WID3; ++i) sum += blockData[i];
+      remainingMass += sum*params[BlockParams::DVX]*params[BlockParams::DVY]*params[BlockParams::DVZ];
+   }
+   if (remainingMass == 0.0) return;
+
+   const Realf factor = (remainingMass + removedMass) / remainingMass;
+   for (size_t i=0; i<nBlocks*WID3; ++i) data[i] *= factor;
+}
+
+/*! Adjust the velocity blocks of one local spatial cell against the content 
+ * lists of its nearest neighbors. Removed mass is returned to the remaining 
+ * blocks if sparse.conserve_mass is set.
+ * \param mpiGrid Spatial grid.
+ * \param cell_id ID of the local spatial cell.
+ * \param popID Particle population ID.
+ */
+void adjustCellVelocityBlocks(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+                              const CellID& cell_id,const int& popID) {
+   SpatialCell* cell = mpiGrid[cell_id];
+      
+   // gather spatial neighbor list and create vector with pointers to neighbor spatial cells
+   const vector<CellID>* neighbors = mpiGrid.get_neighbors_of(cell_id, NEAREST_NEIGHBORHOOD_ID);
+   vector<SpatialCell*> neighbor_ptrs;
+   neighbor_ptrs.reserve(neighbors->size());
+   for (vector<CellID>::const_iterator neighbor_id = neighbors->begin(); neighbor_id != neighbors->end(); ++neighbor_id) {
+      if (*neighbor_id == 0 || *neighbor_id == cell_id) {
+         continue;
+      }
+      neighbor_ptrs.push_back(mpiGrid[*neighbor_id]);
+   }
+   // The mass of removed blocks is accumulated to RHOLOSSADJUST, so 
+   // there is no need to sum up the distribution before adjusting
+   const Real lossAdjustBefore = cell->parameters[CellParams::RHOLOSSADJUST];
+   cell->adjust_velocity_blocks(neighbor_ptrs,popID);
+   const Real removedMass = cell->parameters[CellParams::RHOLOSSADJUST] - lossAdjustBefore;
+
+   if (P::sparse_conserve_mass && removedMass != 0.0) {
+      rescaleVelocityBlocksToConserveMass(cell,popID,removedMass);
+   }
+}
+
+/*! Re-adjust cells that hold more velocity blocks than sparse.maxBlocksPerCell 
+ * allows. This is the only place where the sparsity threshold scale of the cells 
+ * is updated: the scale of over-budget cells is doubled and the cells are adjusted 
+ * again with the raised threshold, the scale of cells well under the budget is 
+ * relaxed for the next adjustment. Collective operation on MPI_COMM_WORLD, the 
+ * number of budget events is written into the logfile.
+ * 
+ * The content lists of the re-adjusted cells are sent to remote neighbors before 
+ * the second adjustment. Neighbors of over-budget cells are not adjusted again, 
+ * they were adjusted against the longer content lists and can only keep some 
+ * extra blocks until the next adjustment.
+ * \param mpiGrid Spatial grid.
+ * \param cellsToAdjust Local cells that were adjusted.
+ * \param popID Particle population ID.
+ */
+void enforceCellBlockBudget(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+                            const vector<CellID>& cellsToAdjust,const int& popID) {
+   phiprof::start("Enforce block budget");
+   vector<CellID> overBudget;
+   for (size_t i=0; i<cellsToAdjust.size(); ++i) {
+      if (mpiGrid[cellsToAdjust[i]]->updateSparseMinValueScale(popID,P::sparseMaxBlocksPerCell) == true) {
+         overBudget.push_back(cellsToAdjust[i]);
+      }
+   }
+
+   uint64_t localEvents = overBudget.size();
+   uint64_t globalEvents = 0;
+   MPI_Allreduce(&localEvents,&globalEvents,1,MPI_UINT64_T,MPI_SUM,MPI_COMM_WORLD);
+   if (globalEvents == 0) {
+      phiprof::stop("Enforce block budget");
+      return;
+   }
+
+   // Content lists of all over-budget cells have to be updated before 
+   // any of them is re-adjusted, as neighbors read each other's lists
+   #pragma omp parallel for
+   for (size_t i=0; i<overBudget.size(); ++i) {
+      SpatialCell* cell = mpiGrid[overBudget[i]];
+      cell->updateSparseMinValue(popID);
+      cell->update_velocity_block_content_lists(popID);
+   }
+   SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_WITH_CONTENT_STAGE1);
+   mpiGrid.update_copies_of_remote_neighbors(NEAREST_NEIGHBORHOOD_ID);
+   SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_WITH_CONTENT_STAGE2);
+   mpiGrid.update_copies_of_remote_neighbors(NEAREST_NEIGHBORHOOD_ID);
+
+   #pragma omp parallel for schedule(dynamic)
+   for (size_t i=0; i<overBudget.size(); ++i) {
+      adjustCellVelocityBlocks(mpiGrid,overBudget[i],popID);
+   }
+   
+   logFile << "(BLOCKS): " << globalEvents << " cells of population " << popID
+           << " exceeded the budget of " << P::sparseMaxBlocksPerCell << " blocks, sparsity threshold raised, tstep = "
+           << P::tstep << endl << writeVerbose;
+   phiprof::stop("Enforce block budget");
+}
+
+/*! Check the number of velocity blocks on this process against 
+ * sparse.maxBlocksPerRank. A process that holds more than 
+ * sparse.rankBudgetRebalanceFraction of its budget requests a load balance. 
+ * A process that is over its budget although load was balanced recently 
+ * doubles the sparsity thresholds of all its cells instead. The thresholds 
+ * are relaxed again once the process is under half of its budget. Collective 
+ * operation on MPI_COMM_WORLD.
+ * \param mpiGrid Spatial grid.
+ * \param recentlyRebalanced If true, load was balanced due to the budget within 
+ * the last sparse.rankBudgetRebalanceInterval steps.
+ * \return If true, some process is close to its budget and load should be balanced.
+ */
+bool checkRankBlockBudget(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+                          const bool& recentlyRebalanced) {
+   const vector<CellID>& cells = getLocalCells();
+   uint64_t localBlocks = 0;
+   for (size_t i=0; i<cells.size(); ++i) {
+      localBlocks += mpiGrid[cells[i]]->get_number_of_all_velocity_blocks();
+   }
+
+   const Real maxScale = 1024.0;
+   int localFlags[2] = {0,0}; // close to budget, thresholds raised
+   if (localBlocks > P::sparseRankBudgetRebalanceFraction*P::sparseMaxBlocksPerRank) {
+      localFlags[0] = 1;
+   }
+   if (localBlocks > P::sparseMaxBlocksPerRank && recentlyRebalanced == true) {
+      P::sparseRankMinValueScale = min(maxScale,(Real)2.0*P::sparseRankMinValueScale);
+      localFlags[1] = 1;
+   } else if (localBlocks < P::sparseMaxBlocksPerRank/2 && P::sparseRankMinValueScale > 1.0) {
+      P::sparseRankMinValueScale = max((Real)1.0,(Real)0.5*P::sparseRankMinValueScale);
+   }
+
+   int globalFlags[2];
+   MPI_Allreduce(localFlags,globalFlags,2,MPI_INT,MPI_SUM,MPI_COMM_WORLD);
+   if (globalFlags[1] > 0) {
+      logFile << "(BLOCKS): " << globalFlags[1] << " processes exceeded the budget of " << P::sparseMaxBlocksPerRank
+              << " blocks after load balancing, sparsity thresholds raised, tstep = " << P::tstep << endl << writeVerbose;
+   }
+   return globalFlags[0] > 0;
+}
+
 /*
   Adjust sparse velocity space to make it consistent in all 6 dimensions.
 
@@ -475,49 +632,53 @@ bool adjustVelocityBlocks(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& m
    SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_WITH_CONTENT_STAGE1 );
    mpiGrid.update_copies_of_remote_neighbors(NEAREST_NEIGHBORHOOD_ID);
    SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_WITH_CONTENT_STAGE2 );
-   mpiGrid.update_copies_of_remote_neighbors(NEAREST_NEIGHBORHOOD_ID);
+   mpiGrid.start_remote_neighbor_copy_updates(NEAREST_NEIGHBORHOOD_ID);
    phiprof::stop("Transfer with_content_list");
+   mpiprogress::exchangeStarted();
    
    //Adjusts velocity blocks in local spatial cells, doesn't adjust velocity blocks in remote cells.
+   //Cells whose neighbors are all local are adjusted while the content lists are in transit.
+   vector<CellID> innerCells;
+   vector<CellID> boundaryCells;
+   for (size_t i=0; i<cellsToAdjust.size(); ++i) {
+      bool hasRemoteNeighbors = false;
+      const vector<CellID>* neighbors = mpiGrid.get_neighbors_of(cellsToAdjust[i],NEAREST_NEIGHBORHOOD_ID);
+      for (size_t n=0; n<neighbors->size(); ++n) {
+         if ((*neighbors)[n] != 0 && mpiGrid.is_local((*neighbors)[n]) == false) hasRemoteNeighbors = true;
+      }
+      if (hasRemoteNeighbors) boundaryCells.push_back(cellsToAdjust[i]);
+      else innerCells.push_back(cellsToAdjust[i]);
+   }
 
    phiprof::start("Adjusting blocks");
    #pragma omp parallel for schedule(dynamic)
-   for (size_t i=0; i<cellsToAdjust.size(); ++i) {
-      Real density_pre_adjust=0.0;
-      Real density_post_adjust=0.0;
-      CellID cell_id=cellsToAdjust[i];
-      SpatialCell* cell = mpiGrid[cell_id];
-      
-      // gather spatial neighbor list and create vector with pointers to neighbor spatial cells
-      const vector<CellID>* neighbors = mpiGrid.get_neighbors_of(cell_id, NEAREST_NEIGHBORHOOD_ID);
-      vector<SpatialCell*> neighbor_ptrs;
-      neighbor_ptrs.reserve(neighbors->size());
-      for (vector<CellID>::const_iterator neighbor_id = neighbors->begin(); neighbor_id != neighbors->end(); ++neighbor_id) {
-         if (*neighbor_id == 0 || *neighbor_id == cell_id) {
-            continue;
-         }
-         neighbor_ptrs.push_back(mpiGrid[*neighbor_id]);
-      }
-      if (P::sparse_conserve_mass) {
-         for (size_t i=0; i<cell->get_number_of_velocity_blocks(popID)*WID3; ++i) {
-            density_pre_adjust += cell->get_data(popID)[i];
-         }
-      }
-      cell->adjust_velocity_blocks(neighbor_ptrs,popID);
+   for (size_t i=0; i<innerCells.size(); ++i) {
+      adjustCellVelocityBlocks(mpiGrid,innerCells[i],popID);
+      mpiprogress::poll();
+   }
+   phiprof::stop("Adjusting blocks");
 
-      if (P::sparse_conserve_mass) {
-         for (size_t i=0; i<cell->get_number_of_velocity_blocks(popID)*WID3; ++i) {
-            density_post_adjust += cell->get_data(popID)[i];
-         }
-         if (density_post_adjust != 0.0) {
-            for (size_t i=0; i<cell->get_number_of_velocity_blocks(popID)*WID3; ++i) {
-               cell->get_data(popID)[i] *= density_pre_adjust/density_post_adjust;
-            }
-         }
-      }
+   mpiprogress::waitStarted();
+   phiprof::start("Transfer with_content_list");
+   mpiGrid.wait_remote_neighbor_copy_update_receives(NEAREST_NEIGHBORHOOD_ID);
+   phiprof::stop("Transfer with_content_list");
+   mpiprogress::waitFinished();
+
+   phiprof::start("Adjusting blocks");
+   #pragma omp parallel for schedule(dynamic)
+   for (size_t i=0; i<boundaryCells.size(); ++i) {
+      adjustCellVelocityBlocks(mpiGrid,boundaryCells[i],popID);
    }
    phiprof::stop("Adjusting blocks");
 
+   phiprof::start("Transfer with_content_list");
+   mpiGrid.wait_remote_neighbor_copy_update_sends();
+   phiprof::stop("Transfer with_content_list");
+
+   if (P::sparseMaxBlocksPerCell > 0) {
+      enforceCellBlockBudget(mpiGrid,cellsToAdjust,popID);
+   }
+   
    //Updated newly adjusted velocity block lists on remote cells, and
    //prepare to receive block data
    if (doPrepareToReceiveBlocks) {
@@ -631,6 +792,9 @@ void updateRemoteVelocityBlockLists(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Ge
    // update velocity block lists For small velocity spaces it is
    // faster to do it in one operation, and not by first sending size,
    // then list. For large we do it in two steps
+   // Both stages are blocking. The second stage needs the sizes sent in the 
+   // first one, and the receives below need the lists, so there is no local 
+   // work to overlap them with and nothing to poll from.
    phiprof::initializeTimer("Velocity block list update","MPI");
    phiprof::start("Velocity block list update");
    SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_LIST_STAGE1);
@@ -85,6 +85,16 @@ bool adjustVelocityBlocks(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& m
                           bool doPrepareToReceiveBlocks,
                             const int& popID);
 
+/*! Check the number of velocity blocks on this process against sparse.maxBlocksPerRank.
+ * Processes that stay over the budget after a load balance raise their sparsity thresholds.
+ * Collective operation on MPI_COMM_WORLD.
+ * \param mpiGrid Spatial grid
+ * \param recentlyRebalanced If true, a budget-triggered load balance happened within sparse.rankBudgetRebalanceInterval steps
+ * \return If true, some process is close to its budget and load should be balanced
+ */
+bool checkRankBlockBudget(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+                          const bool& recentlyRebalanced);
+
 /*! Estimates memory consumption and writes it into logfile. Collective operation on MPI_COMM_WORLD
  * \param mpiGrid Spatial grid
  */
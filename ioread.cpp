@@ -22,6 +22,7 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <fstream>
 #include <iomanip> // for setprecision()
 #include <cmath>
 #include <vector>
@@ -188,7 +189,7 @@ bool readCellIds(vlsv::ParallelReader & file,
    //broadcast cellId's to everybody
    MPI_Bcast(&arraySize,1,MPI_UINT64_T,masterRank,comm);   
    fileCells.resize(arraySize);
-   MPI_Bcast(&(fileCells[0]),arraySize,MPI_UINT64_T,masterRank,comm);
+   MPI_Bcast(fileCells.data(),arraySize,MPI_UINT64_T,masterRank,comm);
 
    return success;
 }
@@ -247,8 +248,10 @@ bool readNBlocks(vlsv::ParallelReader& file,const std::string& meshName,
          return false;
       }
 
+      // Restart subfiles only contain some of the cells
+      const size_t N_fileCells = min(arraySize,N_spatialCells);
       #pragma omp parallel for
-      for (size_t i=0; i<N_spatialCells; ++i) {
+      for (size_t i=0; i<N_fileCells; ++i) {
          nBlocks[i] += buffer[i];
       }
    }
@@ -398,6 +401,7 @@ bool _readBlockData(
  * to this process start.
  * @param localCells Number of spatial cells assigned to this process.
  * @param mpiGrid Parallel grid library.
+ * @param comm MPI comm of the processes that read from the file.
  * @return If true, velocity block data was read successfully.*/
 bool readBlockData(
         vlsv::ParallelReader& file,
@@ -405,13 +409,15 @@ bool readBlockData(
         const vector<CellID>& fileCells,
         const uint64_t localCellStartOffset,
         const uint64_t localCells,
-        dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid
+        dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+        MPI_Comm comm
    ) {
    bool success = true;
 
    const uint64_t bytesReadStart = file.getBytesRead();
-   int N_processes;
-   MPI_Comm_size(MPI_COMM_WORLD,&N_processes);
+   int N_processes,myRank;
+   MPI_Comm_size(comm,&N_processes);
+   MPI_Comm_rank(comm,&myRank);
 
    uint64_t arraySize;
    uint64_t vectorSize;
@@ -443,11 +449,11 @@ bool readBlockData(
       
       // Gather all block sums to master process who will them broadcast 
       // the values to everyone
-      MPI_Allgather(&blockSum,1,MPI_Type<uint64_t>(),offsetArray,1,MPI_Type<uint64_t>(),MPI_COMM_WORLD);      
+      MPI_Allgather(&blockSum,1,MPI_Type<uint64_t>(),offsetArray,1,MPI_Type<uint64_t>(),comm);      
       
       // Calculate the offset from which this process starts reading block data
       uint64_t myOffset = 0;
-      for (uint64_t i=0; i<mpiGrid.get_rank(); ++i) myOffset += offsetArray[i];
+      for (int i=0; i<myRank; ++i) myOffset += offsetArray[i];
       
       if (file.getArrayInfo("BLOCKVARIABLE",attribs,arraySize,vectorSize,dataType,byteSize) == false) {
          logFile << "(RESTART)  ERROR: Failed to read BLOCKVARIABLE INFO" << endl << write;
@@ -675,6 +681,69 @@ bool checkScalarParameter(vlsv::ParallelReader& file,const string& name,T correc
    }
 }
 
+/*! Get the names of the files that make up a restart. A restart written as 
+ * subfiles is read through its index file, which lists the subfiles in rank 
+ * order. Any other file is a normal restart file that contains all cells.
+ * \param name Name of the restart file or subfile index.
+ * \param fileNames Vector in which the names of the files to read are stored.
+ * \return Returns true if the operation was successful.
+ */
+bool readSubfileIndex(const string& name,vector<string>& fileNames) {
+   bool success = true;
+   int myRank;
+   MPI_Comm_rank(MPI_COMM_WORLD,&myRank);
+
+   // Master reads the index and broadcasts the names, separated by newlines
+   string names;
+   if (myRank == MASTER_RANK) {
+      ifstream index(name.c_str());
+      string tag;
+      index >> tag;
+      if (tag != SUBFILE_INDEX_TAG) {
+         names = name + "\n";
+      } else {
+         // Subfile names are relative to the directory of the index file
+         const size_t slash = name.find_last_of('/');
+         const string directory = (slash == string::npos) ? "" : name.substr(0,slash+1);
+         int nSubfiles = 0;
+         index >> nSubfiles;
+         for (int i=0; i<nSubfiles; ++i) {
+            string subfile;
+            index >> subfile;
+            names += directory + subfile + "\n";
+         }
+         if (index.fail() || nSubfiles <= 0) success = false;
+      }
+   }
+   uint64_t length = names.size();
+   MPI_Bcast(&length,1,MPI_UINT64_T,MASTER_RANK,MPI_COMM_WORLD);
+   names.resize(length);
+   MPI_Bcast(&(names[0]),length,MPI_CHAR,MASTER_RANK,MPI_COMM_WORLD);
+
+   fileNames.clear();
+   stringstream ss(names);
+   string fileName;
+   while (getline(ss,fileName)) fileNames.push_back(fileName);
+   return success;
+}
+
+/*! Create a communicator for the ranks that read from one restart subfile. 
+ * Only the ranks from first to last (inclusive) call this function.
+ * \param first First rank in MPI_COMM_WORLD that reads from the subfile.
+ * \param last Last rank in MPI_COMM_WORLD that reads from the subfile.
+ * \param tag Tag that separates the communicators of different subfiles.
+ * \param comm The new communicator, free it with MPI_Comm_free.
+ */
+void createReaderComm(const int first,const int last,const int tag,MPI_Comm& comm) {
+   MPI_Group worldGroup,readerGroup;
+   int range[1][3] = {{first,last,1}};
+   MPI_Comm_group(MPI_COMM_WORLD,&worldGroup);
+   MPI_Group_range_incl(worldGroup,1,range,&readerGroup);
+   MPI_Comm_create_group(MPI_COMM_WORLD,readerGroup,tag,&comm);
+   MPI_Group_free(&readerGroup);
+   MPI_Group_free(&worldGroup);
+}
+
 /*!
 \brief Read in state from a vlsv file in order to restart simulations
 \param mpiGrid Vlasiator's grid
@@ -698,10 +767,34 @@ bool exec_readGrid(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
 
    phiprof::start("readGrid");
 
+   // A restart written as subfiles is read in two passes, layout and data. In 
+   // each pass a subfile is opened once, only by the ranks that read from it. 
+   // Cells are concatenated over the subfiles in the same order as in a single file.
+   vector<string> fileNames;
+   success = readSubfileIndex(name,fileNames);
+   exitOnError(success,"(RESTART) Could not read subfile index",MPI_COMM_WORLD);
+   const int nFiles = fileNames.size();
+   const bool singleFile = (nFiles == 1);
+   vector<vector<CellID> > subfileCells(nFiles);
+   vector<vector<size_t> > subfileBlocks(nFiles);
+   vector<uint64_t> subfileStart(nFiles);
+
+   // The header and data layout of each subfile are read by an even share of 
+   // the ranks. With more subfiles than ranks each rank reads several 
+   // subfiles on its own.
+   vector<int> firstReader(nFiles+1);
+   for (int f=0; f<=nFiles; ++f) firstReader[f] = (int64_t)f*processes/nFiles;
+   vector<int> myFiles;
+   for (int f=0; f<nFiles; ++f) {
+      if (myRank >= firstReader[f] && myRank <= max(firstReader[f],firstReader[f+1]-1)) myFiles.push_back(f);
+   }
+   MPI_Comm readComm = MPI_COMM_WORLD;
+   if (singleFile == false) MPI_Comm_split(MPI_COMM_WORLD,myFiles[0],myRank,&readComm);
+
    vlsv::ParallelReader file;
    MPI_Info mpiInfo = MPI_INFO_NULL;
 
-   if (file.open(name,MPI_COMM_WORLD,MASTER_RANK,mpiInfo) == false) {
+   if (file.open(fileNames[myFiles[0]],readComm,MASTER_RANK,mpiInfo) == false) {
       success=false;
    }
    exitOnError(success,"(RESTART) Could not open file",MPI_COMM_WORLD);
@@ -743,7 +836,40 @@ bool exec_readGrid(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    checkScalarParameter(file,"zcells_ini",P::zcells_ini,MASTER_RANK,MPI_COMM_WORLD);
 
    phiprof::start("readDatalayout");
-   if (success == true) success = readCellIds(file,fileCells,MASTER_RANK,MPI_COMM_WORLD);
+   for (size_t i=0; i<myFiles.size(); ++i) {
+      const int f = myFiles[i];
+      if (i > 0) {
+         if (file.open(fileNames[f],readComm,MASTER_RANK,mpiInfo) == false) success = false;
+         exitOnError(success,"(RESTART) Could not open file",readComm);
+      }
+      if (success == true) success = readCellIds(file,subfileCells[f],MASTER_RANK,readComm);
+
+      // Read the total number of velocity blocks in each spatial cell.
+      // Note that this is a sum over all existing particle species.
+      if (success == true) {
+         success = readNBlocks(file,meshName,subfileBlocks[f],MASTER_RANK,readComm);
+      }
+      subfileBlocks[f].resize(subfileCells[f].size());
+
+      // A single restart file stays open for reading the data
+      if (singleFile == false) file.close();
+   }
+   if (singleFile == false) MPI_Comm_free(&readComm);
+
+   // The first reader of each subfile shares its layout with everyone
+   for (int f=0; f<nFiles; ++f) {
+      if (singleFile == false) {
+         uint64_t nCells = subfileCells[f].size();
+         MPI_Bcast(&nCells,1,MPI_UINT64_T,firstReader[f],MPI_COMM_WORLD);
+         subfileCells[f].resize(nCells);
+         subfileBlocks[f].resize(nCells);
+         MPI_Bcast(subfileCells[f].data(),nCells,MPI_UINT64_T,firstReader[f],MPI_COMM_WORLD);
+         MPI_Bcast(subfileBlocks[f].data(),nCells,MPI_Type<size_t>(),firstReader[f],MPI_COMM_WORLD);
+      }
+      subfileStart[f] = fileCells.size();
+      fileCells.insert(fileCells.end(),subfileCells[f].begin(),subfileCells[f].end());
+      nBlocks.insert(nBlocks.end(),subfileBlocks[f].begin(),subfileBlocks[f].end());
+   }
 
    // Check that the cellID lists are identical in file and grid
    if (myRank==0){
@@ -755,12 +881,6 @@ bool exec_readGrid(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    
    exitOnError(success,"(RESTART) Wrong number of cells in restart file",MPI_COMM_WORLD);
 
-   // Read the total number of velocity blocks in each spatial cell.
-   // Note that this is a sum over all existing particle species.
-   if (success == true) {
-      success = readNBlocks(file,meshName,nBlocks,MASTER_RANK,MPI_COMM_WORLD);
-   }
-
    //make sure all cells are empty, we will anyway overwrite everything and 
    // in that case moving cells is easier...
      {
@@ -781,12 +901,14 @@ bool exec_readGrid(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    uint64_t localCellStartOffset=0; // This is where local cells start in file-list after migration.
    uint64_t localCells=0;
    uint64_t numberOfBlocksCount=0;
+   vector<int> cellProcess(fileCells.size());
    
    // Pin local cells to remote processes, we try to balance number of blocks so that 
    // each process has the same amount of blocks, more or less.
    for (size_t i=0; i<fileCells.size(); ++i) {
       numberOfBlocksCount += nBlocks[i];
       int newCellProcess = numberOfBlocksCount/numberOfBlocksPerProcess;
+      cellProcess[i] = newCellProcess;
       if (newCellProcess == myRank) {
          if (localCells == 0)
             localCellStartOffset=i; //here local cells start
@@ -846,33 +968,58 @@ bool exec_readGrid(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    phiprof::stop("readDatalayout");
 
    //todo, check file datatype, and do not just use double
-   phiprof::start("readCellParameters");
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"perturbed_B",CellParams::PERBX,3,mpiGrid); }
+   for (int f=0; f<nFiles; ++f) {
+      // Part of the local cells that is stored in this file
+      const uint64_t subfileEnd = subfileStart[f] + subfileCells[f].size();
+      const uint64_t first = max(localCellStartOffset,subfileStart[f]);
+      const uint64_t last = min(localCellStartOffset+localCells,subfileEnd);
+      const uint64_t offset = (last > first) ? first - subfileStart[f] : 0;
+      const uint64_t count = (last > first) ? last - first : 0;
+      const vector<CellID>& cells = subfileCells[f];
+
+      // A subfile is read only by the ranks its cells were pinned to. These 
+      // are consecutive, as cells are pinned in increasing rank order.
+      if (singleFile == false) {
+         if (subfileEnd == subfileStart[f]) continue;
+         const int firstRank = cellProcess[subfileStart[f]];
+         const int lastRank = cellProcess[subfileEnd-1];
+         if (myRank < firstRank || myRank > lastRank) continue;
+
+         createReaderComm(firstRank,lastRank,f,readComm);
+         if (file.open(fileNames[f],readComm,MASTER_RANK,mpiInfo) == false) success = false;
+         exitOnError(success,"(RESTART) Could not open file",readComm);
+      }
+
+      phiprof::start("readCellParameters");
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"perturbed_B",CellParams::PERBX,3,mpiGrid); }
 // Backround B has to be set, there are also the derivatives that should be written/read if we wanted to only read in background field
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"moments",CellParams::RHO,4,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"moments_dt2",CellParams::RHO_DT2,4,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"moments_r",CellParams::RHO_R,4,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"moments_v",CellParams::RHO_V,4,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"pressure",CellParams::P_11,3,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"pressure_dt2",CellParams::P_11_DT2,3,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"pressure_r",CellParams::P_11_R,3,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"pressure_v",CellParams::P_11_V,3,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"LB_weight",CellParams::LBWEIGHTCOUNTER,1,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"max_v_dt",CellParams::MAXVDT,1,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"max_r_dt",CellParams::MAXRDT,1,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"max_fields_dt",CellParams::MAXFDT,1,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"rho_loss_adjust",CellParams::RHOLOSSADJUST,1,mpiGrid); }
-   if(success) { success=readCellParamsVariable(file,fileCells,localCellStartOffset,localCells,"rho_loss_velocity_boundary",CellParams::RHOLOSSVELBOUNDARY,1,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"moments",CellParams::RHO,4,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"moments_dt2",CellParams::RHO_DT2,4,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"moments_r",CellParams::RHO_R,4,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"moments_v",CellParams::RHO_V,4,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"pressure",CellParams::P_11,3,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"pressure_dt2",CellParams::P_11_DT2,3,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"pressure_r",CellParams::P_11_R,3,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"pressure_v",CellParams::P_11_V,3,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"LB_weight",CellParams::LBWEIGHTCOUNTER,1,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"max_v_dt",CellParams::MAXVDT,1,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"max_r_dt",CellParams::MAXRDT,1,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"max_fields_dt",CellParams::MAXFDT,1,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"rho_loss_adjust",CellParams::RHOLOSSADJUST,1,mpiGrid); }
+      if(success) { success=readCellParamsVariable(file,cells,offset,count,"rho_loss_velocity_boundary",CellParams::RHOLOSSVELBOUNDARY,1,mpiGrid); }
 // Backround B has to be set, there are also the derivatives that should be written/read if we wanted to only read in background field
-   phiprof::stop("readCellParameters");
+      phiprof::stop("readCellParameters");
 
-   phiprof::start("readBlockData");
-   if (success == true) {
-      success = readBlockData(file,meshName,fileCells,localCellStartOffset,localCells,mpiGrid); 
+      phiprof::start("readBlockData");
+      if (success == true) {
+         success = readBlockData(file,meshName,cells,offset,count,mpiGrid,readComm); 
+      }
+      phiprof::stop("readBlockData");
+
+      if (file.close() == false) success = false;
+      if (singleFile == false) MPI_Comm_free(&readComm);
    }
-   phiprof::stop("readBlockData");
 
-   success = file.close();
    phiprof::stop("readGrid");
 
    exitOnError(success,"(RESTART) Other failure",MPI_COMM_WORLD);
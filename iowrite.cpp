@@ -26,6 +26,7 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <fstream>
 #include <iomanip> // for setprecision()
 #include <cmath>
 #include <sstream>
@@ -182,16 +183,28 @@ bool writeVelocityDistributionData(const int& popID,Writer& vlsvWriter,
    ss << static_cast<unsigned int>(getObjectWrapper().velocityMeshes[meshID].refLevelMaxAllowed);
    attribs["max_velocity_ref_level"] = ss.str();
    
-   if (mpiGrid.get_rank() == MASTER_RANK) {
+   int commRank;
+   MPI_Comm_rank(comm,&commRank);
+   if (commRank == MASTER_RANK) {
       if (vlsvWriter.writeArray("MESH_BBOX",attribs,6,1,bbox) == false) success = false;
 
       for (int crd=0; crd<3; ++crd) {
          const size_t N_nodes = bbox[crd]*bbox[crd+3]+1;
          Real* crds = new Real[N_nodes];
-         const Real dV = getObjectWrapper().velocityMeshes[meshID].cellSize[crd];
-
-         for (size_t i=0; i<N_nodes; ++i) {
-            crds[i] = getObjectWrapper().velocityMeshes[meshID].meshMinLimits[crd] + i*dV;
+         const vmesh::MeshParameters& meshParams = getObjectWrapper().velocityMeshes[meshID];
+
+         if (meshParams.blockEdges[crd].size() == 0) {
+            const Real dV = meshParams.cellSize[crd];
+            for (size_t i=0; i<N_nodes; ++i) {
+               crds[i] = meshParams.meshMinLimits[crd] + i*dV;
+            }
+         } else {
+            // Stretched coordinate, cells are uniform inside each block
+            for (size_t i=0; i<N_nodes; ++i) {
+               const size_t block = min(i/bbox[crd+3],(size_t)bbox[crd]-1);
+               const Real dV = (meshParams.blockEdges[crd][block+1]-meshParams.blockEdges[crd][block]) / bbox[crd+3];
+               crds[i] = meshParams.blockEdges[crd][block] + (i - block*bbox[crd+3])*dV;
+            }
          }
 
          if (crd == 0) {
@@ -230,7 +243,7 @@ bool writeVelocityDistributionData(const int& popID,Writer& vlsvWriter,
       success=false;
    }
 
-   if (globalSuccess(success,"(MAIN) writeGrid: ERROR: Failed to fill temporary array velocityBlockIds",MPI_COMM_WORLD) == false) {
+   if (globalSuccess(success,"(MAIN) writeGrid: ERROR: Failed to fill temporary array velocityBlockIds",comm) == false) {
       vlsvWriter.close();
       return false;
    }
@@ -278,7 +291,7 @@ bool writeVelocityDistributionData(const int& popID,Writer& vlsvWriter,
    // Write the subarrays
    vlsvWriter.endMultiwrite("BLOCKVARIABLE", attribs);
 
-   if (globalSuccess(success,"(MAIN) writeGrid: ERROR: Failed to fill temporary velocityBlockData array",MPI_COMM_WORLD) == false) {
+   if (globalSuccess(success,"(MAIN) writeGrid: ERROR: Failed to fill temporary velocityBlockData array",comm) == false) {
       vlsvWriter.close();
       return false;
    }
@@ -992,6 +1005,82 @@ bool writeGrid(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    return success;
 }
 
+/*! Write the index file of a restart written as subfiles. The index is a 
+ * small text file that lists the subfile names in rank order, relative to 
+ * the directory of the index file.
+ \param indexName Name of the index file.
+ \param name Name of the restart series, e.g. "restart".
+ \param fileIndex Index of the restart.
+ \param currentDate Date string shared by all subfiles.
+ \param nSubfiles Number of subfiles.
+ \return Returns true if the index file was written successfully.
+ */
+bool writeSubfileIndex(const string& indexName,const string& name,const uint& fileIndex,
+                       const char* currentDate,const int& nSubfiles) {
+   ofstream index(indexName.c_str());
+   if (index.good() == false) {
+      logFile << "(writeRestart) ERROR: Failed to open subfile index " << indexName << endl << writeVerbose;
+      return false;
+   }
+   index << SUBFILE_INDEX_TAG << " " << nSubfiles << endl;
+   for (int i=0; i<nSubfiles; ++i) {
+      index << name << ".";
+      index.width(7);
+      index.fill('0');
+      index << fileIndex << "." << currentDate << ".";
+      index.width(5);
+      index.fill('0');
+      index << i << ".vlsv" << endl;
+   }
+   index.close();
+   return index.good();
+}
+
+/*! Split the processes into the groups that write one restart subfile each. 
+ * A group consists of whole compute nodes, so that each node has a single 
+ * MPI-IO aggregator and no node writes into two subfiles.
+ \param nSubfiles Requested number of subfiles, reduced to the number of nodes if larger.
+ \param subfileIndex Index of the subfile this process writes.
+ \param writeComm Communicator of the processes that write the same subfile.
+ \param groupNodes Number of nodes in the group of this process.
+ */
+void splitRestartSubfiles(int& nSubfiles,int& subfileIndex,MPI_Comm& writeComm,int& groupNodes) {
+   int myRank;
+   MPI_Comm_rank(MPI_COMM_WORLD,&myRank);
+
+   // Number the nodes by the lowest rank on each node
+   MPI_Comm nodeComm;
+   int nodeRank,nodeIndex,nNodes;
+   MPI_Comm_split_type(MPI_COMM_WORLD,MPI_COMM_TYPE_SHARED,myRank,MPI_INFO_NULL,&nodeComm);
+   MPI_Comm_rank(nodeComm,&nodeRank);
+   const int isNodeMaster = (nodeRank == 0) ? 1 : 0;
+   MPI_Exscan(&isNodeMaster,&nodeIndex,1,MPI_INT,MPI_SUM,MPI_COMM_WORLD);
+   if (myRank == 0) nodeIndex = 0;
+   MPI_Bcast(&nodeIndex,1,MPI_INT,0,nodeComm);
+   MPI_Allreduce(&isNodeMaster,&nNodes,1,MPI_INT,MPI_SUM,MPI_COMM_WORLD);
+   MPI_Comm_free(&nodeComm);
+
+   nSubfiles = min(nSubfiles,nNodes);
+   if (nSubfiles > 1) {
+      subfileIndex = (int64_t)nodeIndex*nSubfiles/nNodes;
+      MPI_Comm_split(MPI_COMM_WORLD,subfileIndex,myRank,&writeComm);
+      MPI_Allreduce(&isNodeMaster,&groupNodes,1,MPI_INT,MPI_SUM,writeComm);
+   } else {
+      subfileIndex = 0;
+      writeComm = MPI_COMM_WORLD;
+      groupNodes = nNodes;
+   }
+}
+
+/*! Free the communicator and MPI-IO hints used for writing a restart.
+ \param writeComm Communicator of the processes that write the same file, freed if it is not MPI_COMM_WORLD.
+ \param MPIinfo MPI-IO hints, freed if not MPI_INFO_NULL.
+ */
+void freeRestartComm(MPI_Comm& writeComm,MPI_Info& MPIinfo) {
+   if (writeComm != MPI_COMM_WORLD) MPI_Comm_free(&writeComm);
+   if (MPIinfo != MPI_INFO_NULL) MPI_Info_free(&MPIinfo);
+}
+
 /*!
 
 \brief Write out a restart of the simulation into a vlsv file. All block data in remote cells will be reset.
@@ -1034,29 +1123,61 @@ bool writeRestart(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    MPI_Bcast(&currentDate,80,MPI_CHAR,MASTER_RANK,MPI_COMM_WORLD);
    
    // Create a name for the output file and open it with VLSVWriter:
+   stringstream fbase;
+   fbase << P::restartWritePath << "/" << name << ".";
+   fbase.width(7);
+   fbase.fill('0');
+   fbase << fileIndex << "." << currentDate;
+
+   // In subfile mode consecutive nodes are grouped, and each group writes 
+   // its own file. A small index file lists the subfiles in node order.
+   MPI_Comm writeComm = MPI_COMM_WORLD;
+   int nSubfiles = P::restartSubfiles;
+   int subfileIndex = 0;
+   int groupNodes = 0;
+   if (nSubfiles > 1) splitRestartSubfiles(nSubfiles,subfileIndex,writeComm,groupNodes);
    stringstream fname;
-   fname << P::restartWritePath << "/" << name << ".";
-   fname.width(7);
-   fname.fill('0');
-   fname << fileIndex << "." << currentDate << ".vlsv";
+   if (nSubfiles > 1) {
+      fname << fbase.str() << ".";
+      fname.width(5);
+      fname.fill('0');
+      fname << subfileIndex << ".vlsv";
+      if (myRank == MASTER_RANK) {
+         if (writeSubfileIndex(fbase.str()+".vlsvidx",name,fileIndex,currentDate,nSubfiles) == false) success = false;
+      }
+   } else {
+      fname << fbase.str() << ".vlsv";
+   }
 
    phiprof::start("open");
    //Open the file with vlsvWriter:
    Writer vlsvWriter;
    const int masterProcessId = 0;
    MPI_Info MPIinfo; 
-   if (stripe == 0 || stripe < -1){
+   if ((stripe == 0 || stripe < -1) && nSubfiles <= 1){
       MPIinfo = MPI_INFO_NULL;
    } else {
       MPI_Info_create(&MPIinfo);
+   }
+   if (stripe != 0 && stripe >= -1) {
       char stripeChar[6];
       sprintf(stripeChar,"%d",stripe);
       /* no. of I/O devices to be used for file striping */
       char factor[] = "striping_factor";
       MPI_Info_set(MPIinfo, factor, stripeChar);
    }
+   if (nSubfiles > 1) {
+      // One collective buffering aggregator per node in the group
+      char nodesChar[12];
+      sprintf(nodesChar,"%d",groupNodes);
+      char aggregators[] = "cb_nodes";
+      MPI_Info_set(MPIinfo, aggregators, nodesChar);
+   }
    
-   if( vlsvWriter.open( fname.str(), MPI_COMM_WORLD, masterProcessId, MPIinfo ) == false) return false;
+   if( vlsvWriter.open( fname.str(), writeComm, masterProcessId, MPIinfo ) == false) {
+      freeRestartComm(writeComm,MPIinfo);
+      return false;
+   }
 
    phiprof::stop("open");
 
@@ -1075,16 +1196,28 @@ bool writeRestart(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    
    //Write mesh boundaries: NOTE: master process only
    //Visit plugin needs to know the boundaries of the mesh so the number of cells in x, y, z direction
-   if( writeMeshBoundingBox( vlsvWriter, meshName, masterProcessId, MPI_COMM_WORLD ) == false ) return false;
+   if( writeMeshBoundingBox( vlsvWriter, meshName, masterProcessId, writeComm ) == false ) {
+      freeRestartComm(writeComm,MPIinfo);
+      return false;
+   }
    
    //Write the node coordinates: NOTE: master process only
-   if( writeBoundingBoxNodeCoordinates( vlsvWriter, meshName, masterProcessId, MPI_COMM_WORLD ) == false ) return false;
+   if( writeBoundingBoxNodeCoordinates( vlsvWriter, meshName, masterProcessId, writeComm ) == false ) {
+      freeRestartComm(writeComm,MPIinfo);
+      return false;
+   }
    
    //Write basic grid parameters: NOTE: master process only ( I think )
-   if( writeCommonGridData(vlsvWriter, mpiGrid, local_cells, fileIndex, MPI_COMM_WORLD) == false ) return false;
+   if( writeCommonGridData(vlsvWriter, mpiGrid, local_cells, fileIndex, writeComm) == false ) {
+      freeRestartComm(writeComm,MPIinfo);
+      return false;
+   }
    
    //Write zone global id numbers:
-   if( writeZoneGlobalIdNumbers( mpiGrid, vlsvWriter, meshName, local_cells, ghost_cells ) == false ) return false;
+   if( writeZoneGlobalIdNumbers( mpiGrid, vlsvWriter, meshName, local_cells, ghost_cells ) == false ) {
+      freeRestartComm(writeComm,MPIinfo);
+      return false;
+   }
    phiprof::stop("metadataIO");
    phiprof::start("reduceddataIO");   
    //write out DROs we need for restarts
@@ -1121,7 +1254,7 @@ bool writeRestart(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
    // Note: restart should always write double values to ensure the accuracy of the restart runs. 
    // In case of distribution data it is not as important as they are mainly used for visualization purpose
    phiprof::start("velocityspaceIO");
-   writeVelocityDistributionData(vlsvWriter, mpiGrid, local_cells, MPI_COMM_WORLD);
+   writeVelocityDistributionData(vlsvWriter, mpiGrid, local_cells, writeComm);
    phiprof::stop("velocityspaceIO");
 
    phiprof::start("close");
@@ -1135,9 +1268,20 @@ bool writeRestart(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
       updateRemoteVelocityBlockLists(mpiGrid,popID);
    phiprof::stop("updateRemoteBlocks");
 
-   const uint64_t bytesWritten = vlsvWriter.getBytesWritten();
-   const double writeTime = vlsvWriter.getWriteTime();
+   uint64_t bytesWritten = vlsvWriter.getBytesWritten();
+   double writeTime = vlsvWriter.getWriteTime();
+   if (nSubfiles > 1) {
+      // Sum up the sizes of all subfiles, counted once by each subfile master
+      int writeRank;
+      MPI_Comm_rank(writeComm,&writeRank);
+      const uint64_t subfileBytes = (writeRank == masterProcessId) ? bytesWritten : 0;
+      const double subfileTime = writeTime;
+      MPI_Reduce(&subfileBytes,&bytesWritten,1,MPI_UINT64_T,MPI_SUM,MASTER_RANK,MPI_COMM_WORLD);
+      MPI_Reduce(&subfileTime,&writeTime,1,MPI_DOUBLE,MPI_MAX,MASTER_RANK,MPI_COMM_WORLD);
+   }
+   freeRestartComm(writeComm,MPIinfo);
    logFile << "(writeGrid) Wrote ";
+   if (nSubfiles > 1) logFile << nSubfiles << " subfiles, ";
    
    if (bytesWritten > 1.0e9) logFile << bytesWritten/1.0e9 << " GB in ";
    else if (bytesWritten > 1e6) logFile << bytesWritten/1.0e6 << " MB in ";
@@ -0,0 +1,100 @@
+/*
+ * This file is part of Vlasiator.
+ * Copyright 2010-2016 Finnish Meteorological Institute
+ *
+ * For details of usage, see the COPYING file and read the "Rules of the Road"
+ * at http://vlasiator.fmi.fi/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#include <mpi.h>
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
+
+#include "common.h"
+#include "logger.h"
+#include "parameters.h"
+#include "mpi_progress.h"
+
+extern Logger logFile;
+using namespace std;
+
+namespace mpiprogress {
+   // All counters are only touched by the master thread
+   static double exchangeStartTime = 0.0;
+   static double waitStartTime = 0.0;
+   static double overlapTime = 0.0;  /*!< Total time between exchange start and receive wait.*/
+   static double waitTime = 0.0;     /*!< Total time spent waiting for receives.*/
+   static double pollTime = 0.0;     /*!< Total time spent inside MPI_Iprobe.*/
+   static uint64_t exchanges = 0;
+   static uint64_t workItems = 0;
+   static uint64_t polls = 0;
+
+   void exchangeStarted() {
+      exchangeStartTime = MPI_Wtime();
+   }
+
+   void waitStarted() {
+      waitStartTime = MPI_Wtime();
+      overlapTime += waitStartTime - exchangeStartTime;
+   }
+
+   void waitFinished() {
+      waitTime += MPI_Wtime() - waitStartTime;
+      ++exchanges;
+   }
+
+   void poll() {
+      if (Parameters::mpiProgressInterval <= 0) return;
+      #ifdef _OPENMP
+      if (omp_get_thread_num() != 0) return;
+      #endif
+      ++workItems;
+      if (workItems % Parameters::mpiProgressInterval != 0) return;
+
+      const double t_start = MPI_Wtime();
+      int flag;
+      MPI_Iprobe(MPI_ANY_SOURCE,MPI_ANY_TAG,MPI_COMM_WORLD,&flag,MPI_STATUS_IGNORE);
+      pollTime += MPI_Wtime() - t_start;
+      ++polls;
+   }
+
+   void report() {
+      int myRank,nProcs;
+      MPI_Comm_rank(MPI_COMM_WORLD,&myRank);
+      MPI_Comm_size(MPI_COMM_WORLD,&nProcs);
+
+      double localTimes[3] = {overlapTime,waitTime,pollTime};
+      double sumTimes[3];
+      double maxTimes[3];
+      MPI_Reduce(localTimes,sumTimes,3,MPI_DOUBLE,MPI_SUM,MASTER_RANK,MPI_COMM_WORLD);
+      MPI_Reduce(localTimes,maxTimes,3,MPI_DOUBLE,MPI_MAX,MASTER_RANK,MPI_COMM_WORLD);
+
+      double localPolls = polls;
+      double sumPolls;
+      MPI_Reduce(&localPolls,&sumPolls,1,MPI_DOUBLE,MPI_SUM,MASTER_RANK,MPI_COMM_WORLD);
+
+      if (myRank != MASTER_RANK) return;
+      logFile << "(MPI) Halo exchanges: " << exchanges << " on master rank, progress interval " << Parameters::mpiProgressInterval << endl;
+      logFile << "\t overlap window (avg, max): " << sumTimes[0]/nProcs << " " << maxTimes[0] << " s" << endl;
+      logFile << "\t receive wait   (avg, max): " << sumTimes[1]/nProcs << " " << maxTimes[1] << " s" << endl;
+      if (sumTimes[0]+sumTimes[1] > 0.0) {
+         logFile << "\t fraction of exchange time overlapped: " << sumTimes[0]/(sumTimes[0]+sumTimes[1]) << endl;
+      }
+      logFile << "\t progress polls per process " << sumPolls/nProcs << ", time in polls (avg, max): " << sumTimes[2]/nProcs << " " << maxTimes[2] << " s" << endl;
+      logFile << writeVerbose;
+   }
+}
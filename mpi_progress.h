@@ -0,0 +1,54 @@
+/*
+ * This file is part of Vlasiator.
+ * Copyright 2010-2016 Finnish Meteorological Institute
+ *
+ * For details of usage, see the COPYING file and read the "Rules of the Road"
+ * at http://vlasiator.fmi.fi/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MPI_PROGRESS_H
+#define MPI_PROGRESS_H
+
+/*! Progress of non-blocking halo exchanges during computation.
+ * 
+ * Most MPI implementations only move data of pending non-blocking
+ * transfers when the library is entered, so the remote neighbor updates
+ * started by dccrg are largely deferred to the wait calls. When
+ * Parameters::mpiProgressInterval is positive, the compute loops that run
+ * between start_remote_neighbor_copy_updates and the corresponding wait call
+ * poll() once per work item, and every mpiProgressInterval:th call probes
+ * MPI. Only the master thread calls MPI, so MPI_THREAD_FUNNELED is enough.
+ * 
+ * The time between the start of an exchange and its receive wait (the
+ * overlap window) and the time spent in the wait itself are accumulated
+ * for each exchange, so that the amount of hidden communication can be
+ * compared with the mode switched on and off.*/
+namespace mpiprogress {
+   /*! Call right after the exchange has been started.*/
+   void exchangeStarted();
+   /*! Call right before waiting for the receives of the exchange.*/
+   void waitStarted();
+   /*! Call right after the receives of the exchange have completed.*/
+   void waitFinished();
+   /*! Call once per work item inside loops overlapping an exchange. Cheap
+    * when the mode is disabled, may be called from any OpenMP thread.*/
+   void poll();
+   /*! Write the accumulated statistics to logfile. Collective operation
+    * on MPI_COMM_WORLD.*/
+   void report();
+}
+
+#endif
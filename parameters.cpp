@@ -92,6 +92,7 @@ vector<int> P::systemWrites;
 Real P::saveRestartWalltimeInterval = -1.0;
 uint P::exitAfterRestarts = numeric_limits<uint>::max();
 int P::restartStripeFactor = -1;
+uint P::restartSubfiles = 0;
 string P::restartWritePath = string("");
 
 uint P::transmit = 0;
@@ -107,6 +108,7 @@ bool P::dynamicTimestep = true;
 Real P::maxWaveVelocity = 0.0;
 int P::maxFieldSolverSubcycles = 0.0;
 int P::maxSlAccelerationSubcycles = 0.0;
+Real P::accColumnSkipFraction = 0.0;
 Real P::resistivity = NAN;
 bool P::fieldSolverDiffusiveEterms = true;
 uint P::ohmHallTerm = 0;
@@ -125,6 +127,12 @@ Real P::sparseDynamicMinValue1 = 1;
 #warning sparseDynamicMinValue2 needs to be defined per species
 Real P::sparseDynamicMinValue2 = 1;
 
+uint P::sparseMaxBlocksPerCell = 0;
+uint64_t P::sparseMaxBlocksPerRank = 0;
+Real P::sparseRankBudgetRebalanceFraction = 0.9;
+uint P::sparseRankBudgetRebalanceInterval = 10;
+Real P::sparseRankMinValueScale = 1.0;
+
 int P::sparseBlockAddWidthV = 1;
 bool P::sparse_conserve_mass = false;
 
@@ -134,6 +142,7 @@ int P::writeAsFloat = false;
 string P::loadBalanceAlgorithm = string("");
 string P::loadBalanceTolerance = string("");
 uint P::rebalanceInterval = numeric_limits<uint>::max();
+int P::mpiProgressInterval = 0;
 
 vector<string> P::outputVariableList;
 vector<string> P::diagnosticVariableList;
@@ -169,6 +178,7 @@ bool Parameters::addParameters(){
    Readparameters::add("io.restart_walltime_interval","Save the complete simulation in given walltime intervals. Negative values disable writes.",-1.0);
    Readparameters::add("io.number_of_restarts","Exit the simulation after certain number of walltime-based restarts.",numeric_limits<uint>::max());
    Readparameters::add("io.write_restart_stripe_factor","Stripe factor for restart writing.", -1);
+   Readparameters::add("io.write_restart_subfiles","If larger than one, groups of compute nodes write the restart into this many subfiles (at most one per node), which are listed in a .vlsvidx index file. restart.filename may point to the index file.", 0);
    Readparameters::add("io.write_as_float","If true, write in floats instead of doubles", false);
    Readparameters::add("io.restart_write_path", "Path to the location where restart files should be written. Defaults to the local directory, also if the specified destination is not writeable.", string("./"));
    
@@ -212,6 +222,7 @@ bool Parameters::addParameters(){
    // Vlasov solver parameters
    Readparameters::add("vlasovsolver.maxSlAccelerationRotation","Maximum rotation angle (degrees) allowed by the Semi-Lagrangian solver (Use >25 values with care)",25.0);
    Readparameters::add("vlasovsolver.maxSlAccelerationSubcycles","Maximum number of subcycles for acceleration",1);
+   Readparameters::add("vlasovsolver.accColumnSkipFraction","Velocity block columns whose values are all below this fraction of the sparsity threshold are accelerated with a cheap piecewise constant reconstruction. Columns of zeros are always skipped.",0.0);
    Readparameters::add("vlasovsolver.maxCFL","The maximum CFL limit for vlasov propagation in ordinary space. Used to set timestep if dynamic_timestep is true.",0.99);
    Readparameters::add("vlasovsolver.minCFL","The minimum CFL limit for vlasov propagation in ordinary space. Used to set timestep if dynamic_timestep is true.",0.8);
    
@@ -223,6 +234,10 @@ bool Parameters::addParameters(){
    Readparameters::add("sparse.dynamicMinValue1", "The minimum value for the dynamic minValue", 1);
    Readparameters::add("sparse.dynamicMinValue2", "The maximum value (value 2) for the dynamic minValue", 1);
    Readparameters::add("sparse.dynamicBulkValue1", "Minimum value for the dynamic algorithm range, so for example if dynamicAlgorithm=1 then for sparse.dynamicBulkValue1 = 1e3, sparse.dynamicBulkValue2=1e5, we apply the algorithm to cells for which 1e3<cell.rho<1e5", 0);
+   Readparameters::add("sparse.maxBlocksPerCell", "Maximum number of velocity blocks per population in a spatial cell, the sparsity threshold of cells exceeding it is raised temporarily (0 = unlimited)", 0);
+   Readparameters::add("sparse.maxBlocksPerRank", "Maximum number of velocity blocks on one process (0 = unlimited)", 0);
+   Readparameters::add("sparse.rankBudgetRebalanceFraction", "Load is rebalanced immediately if a process holds more than this fraction of sparse.maxBlocksPerRank", 0.9);
+   Readparameters::add("sparse.rankBudgetRebalanceInterval", "Minimum number of timesteps between load balances triggered by sparse.maxBlocksPerRank. A process still over its budget in between raises the sparsity thresholds of its cells.", 10);
    Readparameters::add("sparse.dynamicBulkValue2", "Maximum value for the dynamic algorithm range, so for example if dynamicAlgorithm=1 then for sparse.dynamicBulkValue1 = 1e3, sparse.dynamicBulkValue2=1e5, we apply the algorithm to cells for which 1e3<cell.rho<1e5", 0);
 
    
@@ -232,6 +247,9 @@ bool Parameters::addParameters(){
    Readparameters::add("loadBalance.algorithm", "Load balancing algorithm to be used", string("RCB"));
    Readparameters::add("loadBalance.tolerance", "Load imbalance tolerance", string("1.05"));
    Readparameters::add("loadBalance.rebalanceInterval", "Load rebalance interval (steps)", 10);
+
+   // MPI progress parameters
+   Readparameters::add("mpi.progress_interval", "If positive, the master thread probes MPI every this many work items while halo exchanges are pending, so that the transfers progress during computation. 0 disables.", 0);
    
 // Output variable parameters
    Readparameters::addComposing("variables.output", "List of data reduction operators (DROs) to add to the grid file output. Each variable to be added has to be on a new line output = XXX. Available are (20141218) B BackgroundB PerturbedB E Rho RhoBackstream RhoV RhoVBackstream RhoVNonBackstream PressureBackstream  PTensorBackstreamDiagonal PTensorNonBackstreamDiagonal PTensorBackstreamOffDiagonal PTensorNonBackstreamOffDiagonal PTensorBackstream PTensorNonBackstream RhoNonBackstream RhoLossAdjust RhoLossVelBoundary LBweight MaxVdt MaxRdt MaxFieldsdt accSubcycles MPIrank BoundaryType BoundaryLayer Blocks fSaved VolE HallE BackgroundBedge VolB BackgroundVolB PerturbedVolB Pressure PTensor derivs BVOLderivs.");
@@ -267,6 +285,7 @@ bool Parameters::getParameters(){
    Readparameters::get("io.restart_walltime_interval", P::saveRestartWalltimeInterval);
    Readparameters::get("io.number_of_restarts", P::exitAfterRestarts);
    Readparameters::get("io.write_restart_stripe_factor", P::restartStripeFactor);
+   Readparameters::get("io.write_restart_subfiles", P::restartSubfiles);
    Readparameters::get("io.restart_write_path", P::restartWritePath);
    Readparameters::get("io.write_as_float", P::writeAsFloat);
    
@@ -418,6 +437,7 @@ bool Parameters::getParameters(){
    // Get Vlasov solver parameters
    Readparameters::get("vlasovsolver.maxSlAccelerationRotation",P::maxSlAccelerationRotation);
    Readparameters::get("vlasovsolver.maxSlAccelerationSubcycles",P::maxSlAccelerationSubcycles);
+   Readparameters::get("vlasovsolver.accColumnSkipFraction",P::accColumnSkipFraction);
    Readparameters::get("vlasovsolver.maxCFL",P::vlasovSolverMaxCFL);
    Readparameters::get("vlasovsolver.minCFL",P::vlasovSolverMinCFL);
    
@@ -430,12 +450,19 @@ bool Parameters::getParameters(){
    Readparameters::get("sparse.dynamicBulkValue2", P::sparseDynamicBulkValue2);
    Readparameters::get("sparse.dynamicMinValue1", P::sparseDynamicMinValue1);
    Readparameters::get("sparse.dynamicMinValue2", P::sparseDynamicMinValue2);
+   Readparameters::get("sparse.maxBlocksPerCell", P::sparseMaxBlocksPerCell);
+   Readparameters::get("sparse.maxBlocksPerRank", P::sparseMaxBlocksPerRank);
+   Readparameters::get("sparse.rankBudgetRebalanceFraction", P::sparseRankBudgetRebalanceFraction);
+   Readparameters::get("sparse.rankBudgetRebalanceInterval", P::sparseRankBudgetRebalanceInterval);
 
    
    // Get load balance parameters
    Readparameters::get("loadBalance.algorithm", P::loadBalanceAlgorithm);
    Readparameters::get("loadBalance.tolerance", P::loadBalanceTolerance);
    Readparameters::get("loadBalance.rebalanceInterval", P::rebalanceInterval);
+
+   // Get MPI progress parameters
+   Readparameters::get("mpi.progress_interval", P::mpiProgressInterval);
    
    // Get output variable parameters
    Readparameters::get("variables.output", P::outputVariableList);
@@ -85,6 +85,7 @@ struct Parameters {
    static Real saveRestartWalltimeInterval; /*!< Interval in walltime seconds for restart data*/
    static uint exitAfterRestarts;           /*!< Exit after this many restarts*/
    static int restartStripeFactor;          /*!< stripe_factor for restart writing*/
+   static uint restartSubfiles;             /*!< If larger than one, restarts are written as this many subfiles and an index file.*/
    static std::string restartWritePath;          /*!< Path to the location where restart files should be written. Defaults to the local directory, also if the specified destination is not writeable. */
    
    static uint transmit;
@@ -109,6 +110,7 @@ struct Parameters {
    
    static Real maxSlAccelerationRotation; /*!< Maximum rotation in acceleration for semilagrangian solver*/
    static int maxSlAccelerationSubcycles; /*!< Maximum number of subcycles in acceleration*/
+   static Real accColumnSkipFraction; /*!< Velocity block columns whose values are below this fraction of the sparsity threshold are accelerated with a piecewise constant reconstruction.*/
 
    static Real hallMinimumRho;  /*!< Minimum rho value used for the Hall and electron pressure gradient terms in the Lorentz force and in the field solver.*/
    static Real sparseMinValue; /*!< (DEPRECATED) Minimum value of distribution function in any cell of a velocity 
@@ -121,10 +123,18 @@ struct Parameters {
    static Real sparseDynamicBulkValue2; /*!< Maximum value for the dynamic algorithm range, so for example if dynamicAlgorithm=1 then for sparse.dynamicMinValue = 1e3, sparse.dynamicMaxValue=1e5, we apply the algorithm to cells for which 1e3<cell.rho<1e5*/
    static Real sparseDynamicMinValue1; /*!< The minimum value for the minValue*/
    static Real sparseDynamicMinValue2; /*!< The maximum value for the minValue*/
+   static uint sparseMaxBlocksPerCell; /*!< Maximum number of velocity blocks per population in a spatial cell, 0 = unlimited. 
+                                        * Cells over the budget get a temporarily raised sparsity threshold.*/
+   static uint64_t sparseMaxBlocksPerRank; /*!< Maximum number of velocity blocks on one process, 0 = unlimited.*/
+   static Real sparseRankBudgetRebalanceFraction; /*!< Load is rebalanced immediately when a process holds more than this fraction of sparseMaxBlocksPerRank.*/
+   static uint sparseRankBudgetRebalanceInterval; /*!< Minimum number of timesteps between load balances triggered by sparseMaxBlocksPerRank.*/
+   static Real sparseRankMinValueScale; /*!< Factor applied to the sparsity thresholds of all cells on this process, raised while the 
+                                         * process stays over sparseMaxBlocksPerRank after a load balance.*/
    
    static std::string loadBalanceAlgorithm; /*!< Algorithm to be used for load balance.*/
    static std::string loadBalanceTolerance; /*!< Load imbalance tolerance. */ 
    static uint rebalanceInterval; /*!< Load rebalance interval (steps). */
+   static int mpiProgressInterval; /*!< If positive, MPI is probed every this many work items while halo exchanges are pending, see mpi_progress.h. */
    static bool prepareForRebalance; /**< If true, propagators should measure their time consumption in preparation
                                      * for mesh repartitioning.*/
    
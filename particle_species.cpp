@@ -26,7 +26,11 @@
 
 using namespace std;
 
-species::Species::Species() { }
+species::Species::Species() {
+   maxSpeed = 0.0;
+   maxSpeedRelative = false;
+   maxSpeedThermalFactor = 0.0;
+}
 
 species::Species::Species(const Species& other) {
    name = other.name;
@@ -34,6 +38,9 @@ species::Species::Species(const Species& other) {
    mass = other.mass;   
    sparseMinValue = other.sparseMinValue;
    velocityMesh = other.velocityMesh;
+   maxSpeed = other.maxSpeed;
+   maxSpeedRelative = other.maxSpeedRelative;
+   maxSpeedThermalFactor = other.maxSpeedThermalFactor;
 }
 
 species::Species::~Species() { }
@@ -47,6 +47,11 @@ namespace species {
        Real mass;                      /**< Particle species mass, in simulation units.*/
        Real sparseMinValue;            /**< Sparse mesh threshold value for the population.*/
        size_t velocityMesh;            /**< ID of the velocity mesh (parameters) this species uses.*/
+       Real maxSpeed;                  /**< Velocity blocks are not created beyond this speed. If zero or negative,
+                                        * blocks are only bounded by the velocity mesh extents.*/
+       bool maxSpeedRelative;          /**< If true, maxSpeed is measured from the local bulk velocity.*/
+       Real maxSpeedThermalFactor;     /**< This multiple of the local rms thermal speed is added to maxSpeed
+                                        * (only if maxSpeedRelative is true).*/
        
        Species();
        Species(const Species& other);
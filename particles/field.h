@@ -21,11 +21,21 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 #include <vector>
+#include <iostream>
+#include <cstdlib>
 #include "vectorclass.h"
 #include "vector3d.h"
 #include "boundaries.h"
 #include "particleparameters.h"
 
+// Storage precision of field data. Building with -DPARTICLES_FLOAT_FIELDS halves
+// the memory footprint of the field snapshots; interpolation is still done in double.
+#ifdef PARTICLES_FLOAT_FIELDS
+typedef float FieldReal;
+#else
+typedef double FieldReal;
+#endif
+
 // A 3D cartesian vector field with suitable interpolation properties for
 // particle pushing
 struct Field
@@ -39,25 +49,60 @@ struct Field
    // Information about spatial dimensions (like extent, boundaries, etc)
    Boundary* dimension[3];
 
+   // Box of cells (in mesh cell coordinates) that is actually held in data.
+   // Normally this is the whole mesh, but it can be restricted to the region
+   // around the particle population to save memory.
+   int box_min[3];
+   int box_cells[3];
+
    // The actual field data
-   std::vector<double> data;
+   std::vector<FieldReal> data;
 
    // Constructor (primarily here to make sure boundaries are properly initialized as zero)
    Field() {
       for(int i=0; i<3; i++) {
          dimension[i] = nullptr;
+         box_min[i] = 0;
+         box_cells[i] = 0;
       }
    }
 
-   double* getCellRef(int x, int y, int z) {
+   // Set the stored box and allocate data for it
+   void setBox(const int min[3], const int cells[3]) {
+      for(int i=0; i<3; i++) {
+         box_min[i] = min[i];
+         box_cells[i] = cells[i];
+      }
+      data.resize(4*box_cells[0]*box_cells[1]*box_cells[2]);
+   }
 
-      if(dimension[2]->cells == 1) {
-         // Equatorial plane
-         return &(data[4*(y*dimension[0]->cells+x)]);
-      } else {
-         // General 3d case
-         return &(data[4*(z*dimension[0]->cells*dimension[1]->cells + y*dimension[0]->cells + x)]);
+   // Store the whole mesh
+   void setFullBox() {
+      int min[3] = {0,0,0};
+      int cells[3] = {dimension[0]->cells, dimension[1]->cells, dimension[2]->cells};
+      setBox(min,cells);
+   }
+
+   bool isInBox(int x, int y, int z) const {
+      return x >= box_min[0] && x < box_min[0]+box_cells[0]
+         && y >= box_min[1] && y < box_min[1]+box_cells[1]
+         && z >= box_min[2] && z < box_min[2]+box_cells[2];
+   }
+
+   FieldReal* getCellRef(int x, int y, int z) {
+
+      // Cells outside of the stored box have not been loaded. The boundaries map
+      // all cells into the mesh, so this only happens with a restricted box.
+      int c[3] = {x - box_min[0], y - box_min[1], z - box_min[2]};
+      for(int i=0; i<3; i++) {
+         if(c[i] < 0 || c[i] >= box_cells[i]) {
+            std::cerr << "Field lookup in cell (" << x << ", " << y << ", " << z
+               << ") outside of the loaded box, increase particles.field_box_margin." << std::endl;
+            exit(1);
+         }
       }
+
+      return &(data[4*(c[2]*box_cells[0]*box_cells[1] + c[1]*box_cells[0] + c[0])]);
    }
 
    Vec3d getCell(int x, int y, int z) {
@@ -67,10 +112,8 @@ struct Field
       y = dimension[1]->cellCoordinate(y);
       z = dimension[2]->cellCoordinate(z);
 
-      double* cell = getCellRef(x,y,z);
-      Vec3d retval;
-      retval.load_partial(3,cell);
-      return retval;
+      FieldReal* cell = getCellRef(x,y,z);
+      return Vec3d(cell[0],cell[1],cell[2]);
    }
 
    // Round-Brace indexing: indexing by physical location, with interpolation
@@ -147,7 +190,7 @@ struct Interpolated_Field : Field{
     * Inputs are the two fields to interpolate between
     * and the current time.
     */
-   Interpolated_Field(Field& _a, Field& _b, float _t) : a(_a),b(_b),t(_t) {
+   Interpolated_Field(Field& _a, Field& _b, double _t) : a(_a),b(_b),t(_t) {
    }
 
    virtual Vec3d operator()(Vec3d v) {
@@ -24,6 +24,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <omp.h>
+#include <vector>
 #include "vectorclass.h"
 #include "vector3d.h"
 
@@ -39,6 +41,30 @@ class Histogram1D
       }
       ~Histogram1D() {
          delete[] bins;
+         freeThreadBins();
+      }
+
+      /* Give every OpenMP thread a private, zeroed set of bins. Until
+       * mergeThreadBins() is called, addValue() accumulates into the calling
+       * thread's own bins, so it can be used inside parallel loops. */
+      void beginThreadedFill() {
+         freeThreadBins();
+         thread_bins.resize(omp_get_max_threads());
+         for(size_t t=0; t<thread_bins.size(); t++) {
+            thread_bins[t] = new double[num_bins];
+            memset(thread_bins[t], 0, sizeof(double)*num_bins);
+         }
+      }
+
+      /* Sum the thread-private bins into the shared ones and release them. */
+      void mergeThreadBins() {
+         #pragma omp parallel for
+         for(size_t i=0; i<num_bins; i++) {
+            for(size_t t=0; t<thread_bins.size(); t++) {
+               bins[i] += thread_bins[t][i];
+            }
+         }
+         freeThreadBins();
       }
 
       /* Using MPI_Reduce, sum up all CPUs. */
@@ -69,6 +95,19 @@ class Histogram1D
    protected:
       size_t num_bins;
       double* bins;
+      std::vector<double*> thread_bins;
+
+      // Bins that addValue() should write into from the calling thread
+      double* fill_bins() {
+         return thread_bins.empty() ? bins : thread_bins[omp_get_thread_num()];
+      }
+
+      void freeThreadBins() {
+         for(size_t t=0; t<thread_bins.size(); t++) {
+            delete[] thread_bins[t];
+         }
+         thread_bins.clear();
+      }
 
 };
 
@@ -89,7 +128,7 @@ class LinearHistogram1D : public Histogram1D
          } else if (histogram_bin + 1 >= (ssize_t)num_bins) {
             histogram_bin = num_bins - 1;
          }
-         bins[histogram_bin]++;
+         fill_bins()[histogram_bin]++;
       }
 
       virtual void saveAscii(const char* filename) const;
@@ -118,7 +157,7 @@ class LogHistogram1D : public Histogram1D
          } else if (histogram_bin + 1 >= (ssize_t)num_bins) {
             histogram_bin = num_bins - 1;
          }
-         bins[histogram_bin]++;
+         fill_bins()[histogram_bin]++;
       }
 
    private:
@@ -140,6 +179,30 @@ class Histogram2D
       }
       ~Histogram2D() {
          delete[] bins;
+         freeThreadBins();
+      }
+
+      // Give every OpenMP thread a private, zeroed set of bins. Until
+      // mergeThreadBins() is called, addValue() accumulates into the calling
+      // thread's own bins, so it can be used inside parallel loops.
+      void beginThreadedFill() {
+         freeThreadBins();
+         thread_bins.resize(omp_get_max_threads());
+         for(size_t t=0; t<thread_bins.size(); t++) {
+            thread_bins[t] = new double[num_bins[0] * num_bins[1]];
+            memset(thread_bins[t], 0, sizeof(double) * num_bins[0] * num_bins[1]);
+         }
+      }
+
+      // Sum the thread-private bins into the shared ones and release them.
+      void mergeThreadBins() {
+         #pragma omp parallel for
+         for(size_t i=0; i<num_bins[0] * num_bins[1]; i++) {
+            for(size_t t=0; t<thread_bins.size(); t++) {
+               bins[i] += thread_bins[t][i];
+            }
+         }
+         freeThreadBins();
       }
 
       // Using MPI_Reduce, sum up all CPUs.
@@ -169,6 +232,19 @@ class Histogram2D
    protected:
       size_t num_bins[2];
       double* bins;
+      std::vector<double*> thread_bins;
+
+      // Bins that addValue() should write into from the calling thread
+      double* fill_bins() {
+         return thread_bins.empty() ? bins : thread_bins[omp_get_thread_num()];
+      }
+
+      void freeThreadBins() {
+         for(size_t t=0; t<thread_bins.size(); t++) {
+            delete[] thread_bins[t];
+         }
+         thread_bins.clear();
+      }
 };
 
 class LinearHistogram2D : public Histogram2D
@@ -197,7 +273,7 @@ class LinearHistogram2D : public Histogram2D
                histogram_bin[i] = num_bins[i] - 1;
             }
          }
-         bins[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight;
+         fill_bins()[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight;
       }
 
       void addValueLinearInterpolate(Vec2d value, double weight=1.) {
@@ -238,10 +314,10 @@ class LinearHistogram2D : public Histogram2D
          histogram_bin[0] = floor(v[0]);
          histogram_bin[1] = floor(v[1]);
 
-         bins[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight * (1. - a[0]) * (1. - a[1]);
-         bins[histogram_bin[0] + num_bins[0] * (histogram_bin[1] + 1)] += weight * (1. - a[0]) * a[1];
-         bins[histogram_bin[0] + 1 + num_bins[0] * histogram_bin[1]] += weight * a[0] * (1. - a[1]);
-         bins[histogram_bin[0] + 1 + num_bins[0] * (histogram_bin[1] + 1)] += weight * a[0] * a[1];
+         fill_bins()[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight * (1. - a[0]) * (1. - a[1]);
+         fill_bins()[histogram_bin[0] + num_bins[0] * (histogram_bin[1] + 1)] += weight * (1. - a[0]) * a[1];
+         fill_bins()[histogram_bin[0] + 1 + num_bins[0] * histogram_bin[1]] += weight * a[0] * (1. - a[1]);
+         fill_bins()[histogram_bin[0] + 1 + num_bins[0] * (histogram_bin[1] + 1)] += weight * a[0] * a[1];
       }
 
       // Bin-wise arithmetic on histograms
@@ -284,7 +360,7 @@ class LinLogHistogram2D : public Histogram2D
                histogram_bin[i] = num_bins[i] - 1;
             }
          }
-         bins[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight;
+         fill_bins()[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight;
       }
 
       void addValueLinearInterpolate(Vec2d value, double weight=1.) {
@@ -327,10 +403,10 @@ class LinLogHistogram2D : public Histogram2D
          histogram_bin[0] = floor(v[0]);
          histogram_bin[1] = floor(v[1]);
 
-         bins[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight * (1. - a[0]) * (1. - a[1]);
-         bins[histogram_bin[0] + num_bins[0] * (histogram_bin[1] + 1)] += weight * (1. - a[0]) * a[1];
-         bins[histogram_bin[0] + 1 + num_bins[0] * histogram_bin[1]] += weight * a[0] * (1. - a[1]);
-         bins[histogram_bin[0] + 1 + num_bins[0] * (histogram_bin[1] + 1)] += weight * a[0] * a[1];
+         fill_bins()[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight * (1. - a[0]) * (1. - a[1]);
+         fill_bins()[histogram_bin[0] + num_bins[0] * (histogram_bin[1] + 1)] += weight * (1. - a[0]) * a[1];
+         fill_bins()[histogram_bin[0] + 1 + num_bins[0] * histogram_bin[1]] += weight * a[0] * (1. - a[1]);
+         fill_bins()[histogram_bin[0] + 1 + num_bins[0] * (histogram_bin[1] + 1)] += weight * a[0] * a[1];
       }
 
    private:
@@ -366,7 +442,7 @@ class LogHistogram2D : public Histogram2D
                histogram_bin[i] = num_bins[i] - 1;
             }
          }
-         bins[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight;
+         fill_bins()[histogram_bin[0] + num_bins[0] * histogram_bin[1]] += weight;
       }
 
       /* Bin-wise arithmetic on histograms */
@@ -27,6 +27,9 @@
 #include <iostream>
 #include <random>
 #include <string.h>
+#include <limits>
+#include <algorithm>
+#include <omp.h>
 #include "particles.h"
 #include "field.h"
 #include "physconst.h"
@@ -37,6 +40,150 @@
 #include "scenario.h"
 #include "boundaries.h"
 
+/* Restrict field loading to the bounding box of all active particles and of the
+ * region where the scenario injects particles, padded by particles.field_box_margin.
+ * The injection region covers both this and the next input timestep, as the field
+ * loaded now is still interpolated from after the next file has been opened.
+ * The box only ever grows, so regions that have once been populated stay available. */
+static void updateFieldLoadBox(std::vector<Particle>& particles, Scenario* scenario, double time, Field& F) {
+   static bool haveBox = false;
+   static int boxMin[3], boxMax[3];
+
+   double pmin[3] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::max()};
+   double pmax[3] = {-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(),
+      -std::numeric_limits<double>::max()};
+   bool found = false;
+
+   #pragma omp parallel
+   {
+      double tmin[3] = {pmin[0], pmin[1], pmin[2]};
+      double tmax[3] = {pmax[0], pmax[1], pmax[2]};
+      bool tfound = false;
+
+      #pragma omp for nowait
+      for(unsigned int i=0; i<particles.size(); i++) {
+         if(isnan(vector_length(particles[i].x))) {
+            // Skip disabled particles.
+            continue;
+         }
+         tfound = true;
+         for(int d=0; d<3; d++) {
+            tmin[d] = std::min(tmin[d], particles[i].x[d]);
+            tmax[d] = std::max(tmax[d], particles[i].x[d]);
+         }
+      }
+
+      #pragma omp critical
+      {
+         found = found || tfound;
+         for(int d=0; d<3; d++) {
+            pmin[d] = std::min(pmin[d], tmin[d]);
+            pmax[d] = std::max(pmax[d], tmax[d]);
+         }
+      }
+   }
+
+   Vec3d injectMin,injectMax;
+   if(scenario->injectionRegion(time, time + ParticleParameters::input_dt, injectMin, injectMax)) {
+      found = true;
+      for(int d=0; d<3; d++) {
+         pmin[d] = std::min(pmin[d], injectMin[d]);
+         pmax[d] = std::max(pmax[d], injectMax[d]);
+      }
+   }
+
+   if(!found) {
+      return;
+   }
+
+   for(int d=0; d<3; d++) {
+      // Cell coordinates of the padded box, clamped to the mesh
+      int margin = ceil(ParticleParameters::field_box_margin / F.dx[d]) + 1;
+      int cmin = floor((pmin[d] - F.dimension[d]->min) / F.dx[d]) - margin;
+      int cmax = floor((pmax[d] - F.dimension[d]->min) / F.dx[d]) + 1 + margin;
+      cmin = std::max(cmin, 0);
+      cmax = std::min(cmax, F.dimension[d]->cells - 1);
+
+      if(haveBox) {
+         boxMin[d] = std::min(boxMin[d], cmin);
+         boxMax[d] = std::max(boxMax[d], cmax);
+      } else {
+         boxMin[d] = cmin;
+         boxMax[d] = cmax;
+      }
+   }
+   haveBox = true;
+
+   int boxCells[3] = {boxMax[0]-boxMin[0]+1, boxMax[1]-boxMin[1]+1, boxMax[2]-boxMin[2]+1};
+   setFieldLoadBox(boxMin, boxCells);
+}
+
+/* Interleave the lower 21 bits of the three cell coordinates into a Morton key */
+static uint64_t mortonKey(uint64_t x, uint64_t y, uint64_t z) {
+   uint64_t key = 0;
+   for(int b=0; b<21; b++) {
+      key |= ((x >> b) & 1) << (3*b);
+      key |= ((y >> b) & 1) << (3*b+1);
+      key |= ((z >> b) & 1) << (3*b+2);
+   }
+   return key;
+}
+
+/* Sort in parallel: every thread sorts a chunk, then chunks are merged pairwise */
+template<typename T> static void parallelSort(std::vector<T>& v) {
+   const int nChunks = omp_get_max_threads();
+   std::vector<size_t> bounds(nChunks+1);
+   for(int c=0; c<=nChunks; c++) {
+      bounds[c] = v.size() * c / nChunks;
+   }
+
+   #pragma omp parallel for
+   for(int c=0; c<nChunks; c++) {
+      std::sort(v.begin() + bounds[c], v.begin() + bounds[c+1]);
+   }
+
+   for(int width=1; width<nChunks; width*=2) {
+      #pragma omp parallel for
+      for(int c=0; c<nChunks-width; c+=2*width) {
+         std::inplace_merge(v.begin() + bounds[c], v.begin() + bounds[c+width],
+               v.begin() + bounds[std::min(c+2*width, nChunks)]);
+      }
+   }
+}
+
+/* Order in which to push the particles, sorted by the Morton index of the cell
+ * they are in, so that consecutive pushes interpolate from neighbouring cells.
+ * The particle vector itself is not reordered, as scenarios and output identify
+ * particles by their index. Disabled particles go last. */
+static void computePushOrder(std::vector<Particle>& particles, Field& F, std::vector<uint32_t>& order) {
+   std::vector<std::pair<uint64_t,uint32_t> > keys(particles.size());
+
+   #pragma omp parallel for
+   for(unsigned int i=0; i<particles.size(); i++) {
+      if(isnan(vector_length(particles[i].x))) {
+         keys[i] = std::make_pair(std::numeric_limits<uint64_t>::max(), i);
+         continue;
+      }
+
+      uint64_t c[3];
+      for(int d=0; d<3; d++) {
+         int cell = floor((particles[i].x[d] - F.dimension[d]->min) / F.dx[d]);
+         cell = std::max(0, std::min(cell, F.dimension[d]->cells - 1));
+         c[d] = cell;
+      }
+      keys[i] = std::make_pair(mortonKey(c[0],c[1],c[2]), i);
+   }
+
+   parallelSort(keys);
+
+   order.resize(particles.size());
+   #pragma omp parallel for
+   for(unsigned int i=0; i<particles.size(); i++) {
+      order[i] = keys[i].second;
+   }
+}
+
 int main(int argc, char** argv) {
 
    MPI::Init(argc, argv);
@@ -99,10 +246,20 @@ int main(int argc, char** argv) {
    std::cerr << "Pushing " << particles.size() << " particles for " << maxsteps << " steps..." << std::endl;
    std::cerr << "[                                                                        ]\x0d[";
 
+   /* Order in which particles are pushed */
+   std::vector<uint32_t> push_order;
+
    /* Push them around */
    for(int step=0; step<maxsteps; step++) {
 
       bool newfile;
+      double time = ParticleParameters::start_time + step*dt;
+
+      /* If a new file is about to be loaded, only load what the particles need */
+      if(ParticleParameters::field_box_margin >= 0 && (time < E[0].time || time >= E[1].time)) {
+         updateFieldLoadBox(particles, scenario, step*dt, E[1]);
+      }
+
       /* Load newer fields, if neccessary */
       if(step >= 0) {
          newfile = readNextTimestep(filename_pattern, ParticleParameters::start_time + step*dt, 1,E[0], E[1],
@@ -122,8 +279,16 @@ int main(int argc, char** argv) {
 
       scenario->beforePush(particles,cur_E,cur_B,V);
 
+      // Particles have drifted apart, or have been added or removed: resort
+      if(ParticleParameters::sort_interval > 0
+            && (step % ParticleParameters::sort_interval == 0 || push_order.size() != particles.size())) {
+         computePushOrder(particles, E[1], push_order);
+      }
+      const bool use_push_order = (push_order.size() == particles.size());
+
 #pragma omp parallel for
-      for(unsigned int i=0; i< particles.size(); i++) {
+      for(unsigned int n=0; n< particles.size(); n++) {
+         const unsigned int i = use_push_order ? push_order[n] : n;
 
          if(isnan(vector_length(particles[i].x))) {
             // Skip disabled particles.
@@ -40,6 +40,8 @@ Real P::input_dt = 1;
 Real P::start_time = 0;
 Real P::end_time = 0;
 uint64_t P::num_particles = 0;
+Real P::field_box_margin = -1;
+int P::sort_interval = 10;
 
 std::default_random_engine::result_type P::random_seed = 1;
 Distribution* (*P::distribution)(std::default_random_engine&) = NULL;
@@ -88,6 +90,8 @@ bool ParticleParameters::addParameters() {
    Readparameters::add("particles.start_time", "Simulation time (seconds) for particle start.",0);
    Readparameters::add("particles.end_time", "Simulation time (seconds) at which particle simulation stops.",0);
    Readparameters::add("particles.num_particles", "Number of particles to simulate.",10000);
+   Readparameters::add("particles.sort_interval", "Interval (in steps) at which the push order of particles is sorted by their location, 0 disables sorting.",10);
+   Readparameters::add("particles.field_box_margin", "Only load fields within this distance (meters) of the particles' bounding box. The loaded region only ever grows, but it has to cover how far particles travel within one input_dt. Negative values load the whole domain.",-1.);
    Readparameters::add("particles.random_seed", "Random seed for particle creation.",1);
    Readparameters::add("particles.distribution", "Type of distribution function to sample particles from.",
          std::string("maxwell"));
@@ -161,6 +165,8 @@ bool ParticleParameters::getParameters() {
    Readparameters::get("particles.start_time",P::start_time);
    Readparameters::get("particles.end_time",P::end_time);
    Readparameters::get("particles.num_particles",P::num_particles);
+   Readparameters::get("particles.sort_interval",P::sort_interval);
+   Readparameters::get("particles.field_box_margin",P::field_box_margin);
    if(P::dt == 0 || P::end_time <= P::start_time) {
       std::cerr << "Error end_time <= start_time! Won't do anything (and will probably crash now)." << std::endl;
       return false;
@@ -46,6 +46,9 @@ struct ParticleParameters {
 
    static uint64_t num_particles; /*!< Number of particles to generate */
 
+   static int sort_interval; /*!< Interval (in steps) at which particles are sorted by location for pushing, 0 disables sorting */
+   static Real field_box_margin; /*!< Margin (meters) around the particles within which fields are loaded, negative loads the whole domain */
+
    static Boundary* boundary_behaviour_x; /*!< What to do with particles that reach the x boundary */
    static Boundary* boundary_behaviour_y; /*!< What to do with particles that reach the y boundary */
    static Boundary* boundary_behaviour_z; /*!< What to do with particles that reach the z boundary */
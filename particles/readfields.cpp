@@ -66,6 +66,108 @@ std::vector<uint64_t> readCellIds(vlsvinterface::Reader& r) {
    return cellIds;
 }
 
+/* Box of cells to load timesteps into, if restricted */
+static bool fieldLoadBoxActive = false;
+static int fieldLoadBoxMin[3];
+static int fieldLoadBoxCells[3];
+
+void setFieldLoadBox(const int min[3], const int cells[3]) {
+   fieldLoadBoxActive = true;
+   for(int i=0; i<3; i++) {
+      fieldLoadBoxMin[i] = min[i];
+      fieldLoadBoxCells[i] = cells[i];
+   }
+}
+
+void applyFieldLoadBox(Field& F) {
+   if(fieldLoadBoxActive) {
+      F.setBox(fieldLoadBoxMin, fieldLoadBoxCells);
+   } else {
+      F.setFullBox();
+   }
+}
+
+/* Gather index of the last file read, and the cellIds, mesh and box it belongs to */
+static std::vector<uint64_t> gatherIndexCellIds;
+static std::vector<uint64_t> gatherIndex;
+static int gatherIndexCells[3] = {0,0,0};
+static int gatherIndexBoxMin[3] = {0,0,0};
+static int gatherIndexBoxCells[3] = {0,0,0};
+
+const std::vector<uint64_t>& cellGatherIndex(const std::vector<uint64_t>& cellIds, Field& F) {
+
+   bool sameMesh = true;
+   for(int i=0; i<3; i++) {
+      if(gatherIndexCells[i] != F.dimension[i]->cells
+            || gatherIndexBoxMin[i] != F.box_min[i] || gatherIndexBoxCells[i] != F.box_cells[i]) {
+         sameMesh = false;
+      }
+   }
+
+   /* Comparing the cellIds is a single streaming pass, much cheaper than
+    * decomposing every cellId into coordinates again. */
+   if(sameMesh && cellIds == gatherIndexCellIds) {
+      return gatherIndex;
+   }
+
+   uint64_t cells[3];
+   for(int i=0; i<3; i++) {
+      gatherIndexCells[i] = F.dimension[i]->cells;
+      gatherIndexBoxMin[i] = F.box_min[i];
+      gatherIndexBoxCells[i] = F.box_cells[i];
+      cells[i] = F.dimension[i]->cells;
+   }
+   gatherIndexCellIds = cellIds;
+   gatherIndex.resize(cellIds.size());
+
+   #pragma omp parallel for
+   for(uint64_t i=0; i<cellIds.size(); i++) {
+      uint64_t c = cellIds[i]-1;
+      int64_t x = c % cells[0];
+      int64_t y = (c /cells[0]) % cells[1];
+      int64_t z = c /(cells[0]*cells[1]);
+      if(F.isInBox(x,y,z)) {
+         gatherIndex[i] = F.getCellRef(x,y,z) - F.data.data();
+      } else {
+         gatherIndex[i] = NO_GATHER_OFFSET;
+      }
+   }
+
+   return gatherIndex;
+}
+
+void scatterFieldData(const std::vector<uint64_t>& index, const std::vector<double>& buffer, Field& F) {
+   FieldReal* data = F.data.data();
+
+   #pragma omp parallel for
+   for(uint64_t i=0; i<index.size(); i++) {
+      if(index[i] == NO_GATHER_OFFSET) {
+         continue;
+      }
+      FieldReal* tgt = data + index[i];
+      tgt[0] = buffer[3*i];
+      tgt[1] = buffer[3*i+1];
+      tgt[2] = buffer[3*i+2];
+   }
+}
+
+void scatterVelocityData(const std::vector<uint64_t>& index, const std::vector<double>& rho_v_buffer,
+      const std::vector<double>& rho_buffer, Field& V) {
+   FieldReal* data = V.data.data();
+
+   #pragma omp parallel for
+   for(uint64_t i=0; i<index.size(); i++) {
+      if(index[i] == NO_GATHER_OFFSET) {
+         continue;
+      }
+      FieldReal* tgt = data + index[i];
+      const double inv_rho = 1. / rho_buffer[i];
+      tgt[0] = rho_v_buffer[3*i] * inv_rho;
+      tgt[1] = rho_v_buffer[3*i+1] * inv_rho;
+      tgt[2] = rho_v_buffer[3*i+2] * inv_rho;
+   }
+}
+
 /* For debugging purposes - dump a field into a png file
  * We're hardcodedly writing the z=0 plane here. */
 void debug_output(Field& F, const char* filename) {
@@ -77,7 +179,7 @@ void debug_output(Field& F, const char* filename) {
    min[0] = min[1] = min[2] = 99999999999;
    max[0] = max[1] = max[2] = -99999999999;
 
-   for(int i=0; i<F.dimension[0]->cells*F.dimension[1]->cells; i++) {
+   for(int i=0; i<F.box_cells[0]*F.box_cells[1]; i++) {
       for(int j=0; j<3; j++) {
          if(F.data[4*i+j] > max[j]) {
             max[j] = F.data[4*i+j];
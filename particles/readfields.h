@@ -28,6 +28,7 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <stdint.h>
 
 #define DEBUG
 
@@ -37,6 +38,27 @@ extern std::string E_field_name;
 /* Read the cellIDs into an array */
 std::vector<uint64_t> readCellIds(vlsvinterface::Reader& r);
 
+/* Restrict subsequently loaded timesteps to the given box of cells, instead of
+ * the whole mesh (which is the default) */
+void setFieldLoadBox(const int min[3], const int cells[3]);
+
+/* Set up a field's stored box for the next timestep to be loaded into it */
+void applyFieldLoadBox(Field& F);
+
+/* Offsets of each cell (in file order) into the data array of a field with
+ * the given dimensions and stored box. Cells outside the box get NO_GATHER_OFFSET.
+ * Files of the same run normally share their cell order, so the index is only
+ * rebuilt when the cellIds actually change. */
+const uint64_t NO_GATHER_OFFSET = UINT64_MAX;
+const std::vector<uint64_t>& cellGatherIndex(const std::vector<uint64_t>& cellIds, Field& F);
+
+/* Sort 3-component data in file order into place, using a gather index */
+void scatterFieldData(const std::vector<uint64_t>& index, const std::vector<double>& buffer, Field& F);
+
+/* Same, but for the bulk velocity, computed from rho_v and rho on the fly */
+void scatterVelocityData(const std::vector<uint64_t>& index, const std::vector<double>& rho_v_buffer,
+      const std::vector<double>& rho_buffer, Field& V);
+
 template <class Reader>
 static void detect_field_names(Reader& r) {
 
@@ -111,8 +133,9 @@ bool readNextTimestep(const std::string& filename_pattern, double t, int step, F
    while(t < E0.time || t>= E1.time) {
       input_file_counter += step;
 
-      E0=E1;
-      B0=B1;
+      /* Swap instead of copying, the old E0/B0 storage is reused for the new file */
+      std::swap(E0,E1);
+      std::swap(B0,B1);
       snprintf(filename_buffer,256,filename_pattern.c_str(),input_file_counter);
 
       /* Open next file */
@@ -130,53 +153,32 @@ bool readNextTimestep(const std::string& filename_pattern, double t, int step, F
       E1.time = t;
       B1.time = t;
 
-      uint64_t cells[3];
-      r.readParameter("xcells_ini",cells[0]);
-      r.readParameter("ycells_ini",cells[1]);
-      r.readParameter("zcells_ini",cells[2]);
-
       /* Read CellIDs and Field data */
       std::vector<uint64_t> cellIds = readCellIds(r);
       std::string name(B_field_name);
       std::vector<double> Bbuffer = readFieldData(r,name,3u);
       name = E_field_name;
       std::vector<double> Ebuffer = readFieldData(r,name,3u);
-      std::vector<double> Vbuffer;
+      std::vector<double> rho_v_buffer, rho_buffer;
       if(doV) {
         name = "rho_v";
-        std::vector<double> rho_v_buffer = readFieldData(r,name,3u);
+        rho_v_buffer = readFieldData(r,name,3u);
         name = "rho";
-        std::vector<double> rho_buffer = readFieldData(r,name,1u);
-        for(int i=0; i<rho_buffer.size(); i++) {
-          Vbuffer.push_back(rho_v_buffer[3*i] / rho_buffer[i]);
-          Vbuffer.push_back(rho_v_buffer[3*i+1] / rho_buffer[i]);
-          Vbuffer.push_back(rho_v_buffer[3*i+2] / rho_buffer[i]);
-        }
+        rho_buffer = readFieldData(r,name,1u);
       }
 
       /* Assign them, without sanity checking */
       /* TODO: Is this actually a good idea? */
-      for(uint i=0; i< cellIds.size(); i++) {
-         uint64_t c = cellIds[i];
-         int64_t x = c % cells[0];
-         int64_t y = (c /cells[0]) % cells[1];
-         int64_t z = c /(cells[0]*cells[1]);
-
-         double* Etgt = E1.getCellRef(x,y,z);
-         double* Btgt = B1.getCellRef(x,y,z);
-         Etgt[0] = Ebuffer[3*i];
-         Etgt[1] = Ebuffer[3*i+1];
-         Etgt[2] = Ebuffer[3*i+2];
-         Btgt[0] = Bbuffer[3*i];
-         Btgt[1] = Bbuffer[3*i+1];
-         Btgt[2] = Bbuffer[3*i+2];
-
-         if(doV) {
-           double* Vtgt = V.getCellRef(x,y,z);
-           Vtgt[0] = Vbuffer[3*i];
-           Vtgt[1] = Vbuffer[3*i+1];
-           Vtgt[2] = Vbuffer[3*i+2];
-         }
+      applyFieldLoadBox(E1);
+      applyFieldLoadBox(B1);
+      if(doV) {
+         applyFieldLoadBox(V);
+      }
+      const std::vector<uint64_t>& index = cellGatherIndex(cellIds, E1);
+      scatterFieldData(index, Ebuffer, E1);
+      scatterFieldData(index, Bbuffer, B1);
+      if(doV) {
+         scatterVelocityData(index, rho_v_buffer, rho_buffer, V);
       }
 
       r.close();
@@ -250,13 +252,6 @@ void readfields(const char* filename, Field& E, Field& B, Field& V, bool doV=tru
    //          << " with dx = " << ((max[0]-min[0])/cells[0]) << ", dy = " << ((max[1]-min[1])/cells[1])
    //          << ", dz = " << ((max[2]-min[2])/cells[2]) << "." << std::endl;
 
-   /* Allocate space for the actual field structures */
-   E.data.resize(4*cells[0]*cells[1]*cells[2]);
-   B.data.resize(4*cells[0]*cells[1]*cells[2]);
-	 if(doV) {
-		 V.data.resize(4*cells[0]*cells[1]*cells[2]);
-	 }
-
    /* Sanity-check stored data sizes */
    if(3*cellIds.size() != Bbuffer.size()) {
       std::cerr << "3 * cellIDs.size (" << cellIds.size() << ") != Bbuffer.size (" << Bbuffer.size() << ")!"
@@ -299,29 +294,20 @@ void readfields(const char* filename, Field& E, Field& B, Field& V, bool doV=tru
    }
    E.time = B.time = V.time = time;
 
+   /* Allocate space for the actual field structures */
+   E.setFullBox();
+   B.setFullBox();
+   if(doV) {
+      V.setFullBox();
+   }
+
    /* So, now we've got the cellIDs, the mesh size and the field values,
     * we can sort them into place */
-   for(uint i=0; i< cellIds.size(); i++) {
-      uint64_t c = cellIds[i]-1;
-      int64_t x = c % cells[0];
-      int64_t y = (c /cells[0]) % cells[1];
-      int64_t z = c /(cells[0]*cells[1]);
-
-      double* Etgt = E.getCellRef(x,y,z);
-      double* Btgt = B.getCellRef(x,y,z);
-      Etgt[0] = Ebuffer[3*i];
-      Etgt[1] = Ebuffer[3*i+1];
-      Etgt[2] = Ebuffer[3*i+2];
-      Btgt[0] = Bbuffer[3*i];
-      Btgt[1] = Bbuffer[3*i+1];
-      Btgt[2] = Bbuffer[3*i+2];
-
-      if(doV) {
-        double* Vtgt = V.getCellRef(x,y,z);
-        Vtgt[0] = rho_v_buffer[3*i] / rho_buffer[i];
-        Vtgt[1] = rho_v_buffer[3*i+1] / rho_buffer[i];
-        Vtgt[2] = rho_v_buffer[3*i+2] / rho_buffer[i];
-      }
+   const std::vector<uint64_t>& index = cellGatherIndex(cellIds, E);
+   scatterFieldData(index, Ebuffer, E);
+   scatterFieldData(index, Bbuffer, B);
+   if(doV) {
+      scatterVelocityData(index, rho_v_buffer, rho_buffer, V);
    }
 
    r.close();
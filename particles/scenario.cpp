@@ -21,6 +21,8 @@
  */
 #include <random>
 #include <iostream>
+#include <limits>
+#include <algorithm>
 #include "scenario.h"
 
 std::vector<Particle> singleParticleScenario::initialParticles(Field& E, Field& B, Field& V) {
@@ -125,6 +127,15 @@ void precipitationScenario::afterPush(int step, double time, std::vector<Particl
    }
 }
 
+// Extent in z of the search for the minimum of B above and below the x-axis
+static const double precip_search_z = 1e7;
+
+bool precipitationScenario::injectionRegion(double t0, double t1, Vec3d& min, Vec3d& max) {
+   min = Vec3d(std::min(ParticleParameters::precip_start_x, ParticleParameters::precip_stop_x), 0, -precip_search_z);
+   max = Vec3d(std::max(ParticleParameters::precip_start_x, ParticleParameters::precip_stop_x), 0, precip_search_z);
+   return true;
+}
+
 void precipitationScenario::newTimestep(int input_file_counter, int step, double time, std::vector<Particle>& particles,
       Field& E, Field& B, Field& V) {
 
@@ -140,7 +151,7 @@ void precipitationScenario::newTimestep(int input_file_counter, int step, double
 
       // Find cell with minimum B value in this plane
       double min_B = 99999999999.;
-      for(double z=-1e7; z<1e7; z+=1e5) {
+      for(double z=-precip_search_z; z<precip_search_z; z+=1e5) {
          Vec3d candidate_pos(start_x,0,z);
          double B_here = vector_length(B(candidate_pos));
          if(B_here < min_B) {
@@ -191,10 +202,38 @@ void analysatorScenario::newTimestep(int input_file_counter, int step, double ti
    }
 }
 
+// Number of points along the parabola from which particles are injected in front of the shock
+static const int reflect_num_points = 200;
+
+// x-coordinate of the injection parabola at the given y and time
+static double reflectInjectionX(double start_y, double time) {
+   double x = start_y / ParticleParameters::reflect_start_y;
+   x*=-x;
+   x *= ParticleParameters::reflect_y_scale - 10e6*(time-250.)/435.;
+   x += ParticleParameters::reflect_x_offset + 10e6*(time-250.)/435.;
+   return x;
+}
+
+bool shockReflectivityScenario::injectionRegion(double t0, double t1, Vec3d& min, Vec3d& max) {
+   // For a given y, x is linear in time, so the extremes are at t0 or t1
+   double xmin = std::numeric_limits<double>::max();
+   double xmax = -std::numeric_limits<double>::max();
+   for(int i=0; i<reflect_num_points; i++) {
+      double start_y = ParticleParameters::reflect_start_y +
+         ((double)i)/reflect_num_points *
+          (ParticleParameters::reflect_stop_y - ParticleParameters::reflect_start_y);
+      xmin = std::min(xmin, std::min(reflectInjectionX(start_y, t0), reflectInjectionX(start_y, t1)));
+      xmax = std::max(xmax, std::max(reflectInjectionX(start_y, t0), reflectInjectionX(start_y, t1)));
+   }
+   min = Vec3d(xmin, std::min(ParticleParameters::reflect_start_y, ParticleParameters::reflect_stop_y), 0);
+   max = Vec3d(xmax, std::max(ParticleParameters::reflect_start_y, ParticleParameters::reflect_stop_y), 0);
+   return true;
+}
+
 void shockReflectivityScenario::newTimestep(int input_file_counter, int step, double time,
       std::vector<Particle>& particles, Field& E, Field& B, Field& V) {
 
-   const int num_points = 200;
+   const int num_points = reflect_num_points;
 
    std::default_random_engine generator(ParticleParameters::random_seed+step);
    Distribution* velocity_distribution=ParticleParameters::distribution(generator);
@@ -208,10 +247,7 @@ void shockReflectivityScenario::newTimestep(int input_file_counter, int step, do
           (ParticleParameters::reflect_stop_y - ParticleParameters::reflect_start_y);
 
       // Calc x-coordinate from it
-      double x = start_y / ParticleParameters::reflect_start_y;
-      x*=-x;
-      x *= ParticleParameters::reflect_y_scale - 10e6*(time-250.)/435.;
-      x += ParticleParameters::reflect_x_offset + 10e6*(time-250.)/435.;
+      double x = reflectInjectionX(start_y, time);
 
       Vec3d pos(x,start_y,0);
       // Add a particle at this location, with bulk velocity at its starting point
@@ -245,6 +281,11 @@ void shockReflectivityScenario::newTimestep(int input_file_counter, int step, do
 void shockReflectivityScenario::afterPush(int step, double time, std::vector<Particle>& particles,
       Field& E, Field& B, Field& V) {
 
+   // Each thread bins into private copies of the histograms, merged after the loop.
+   transmitted.beginThreadedFill();
+   reflected.beginThreadedFill();
+
+   #pragma omp parallel for
    for(unsigned int i=0; i<particles.size(); i++) {
 
       if(isnan(vector_length(particles[i].x))) {
@@ -286,6 +327,9 @@ void shockReflectivityScenario::afterPush(int step, double time, std::vector<Par
          particles[i].v = Vec3d(0.,0.,0.);
       }
    }
+
+   transmitted.mergeThreadBins();
+   reflected.mergeThreadBins();
 }
 
 void shockReflectivityScenario::finalize(std::vector<Particle>& particles, Field& E, Field& B, Field& V) {
@@ -42,6 +42,10 @@ struct Scenario {
   virtual void newTimestep(int input_file_counter, int step, double time, std::vector<Particle>& particles, Field& E,
         Field& B, Field& V) {};
 
+  // Region in which newTimestep creates particles or looks up fields, for input
+  // timesteps opened between times t0 and t1. Returns false if there is none.
+  virtual bool injectionRegion(double t0, double t1, Vec3d& min, Vec3d& max) {return false;};
+
   // Modify or analyze particle behaviour before they are moved by the particle pusher.
   virtual void beforePush(std::vector<Particle>& particles, Field& E, Field& B, Field& V) {};
 
@@ -85,6 +89,7 @@ struct distributionScenario : Scenario {
 struct precipitationScenario : Scenario {
   void newTimestep(int input_file_counter, int step, double time, std::vector<Particle>& particles, Field& E, Field& B,
         Field& V);
+  bool injectionRegion(double t0, double t1, Vec3d& min, Vec3d& max);
   void afterPush(int step, double time, std::vector<Particle>& particles, Field& E, Field& B, Field& V);
 
   precipitationScenario() {needV = true;};
@@ -106,6 +111,7 @@ struct shockReflectivityScenario : Scenario {
 
   void newTimestep(int input_file_counter, int step, double time, std::vector<Particle>& particles, Field& E, Field& B,
         Field& V);
+  bool injectionRegion(double t0, double t1, Vec3d& min, Vec3d& max);
   void afterPush(int step, double time, std::vector<Particle>& particles, Field& E, Field& B, Field& V);
   void finalize(std::vector<Particle>& particles, Field& E, Field& B, Field& V);
 
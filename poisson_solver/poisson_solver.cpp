@@ -36,6 +36,7 @@
 #include "../grid.h"
 #include "../spatial_cell.hpp"       
 #include "../object_wrapper.h"
+#include "../vlasovsolver/cpu_moments.h"
 
 #include "poisson_solver.h"
 #include "poisson_solver_jacobi.h"
@@ -66,6 +67,27 @@ namespace poisson {
    Real Poisson::minRelativePotentialChange;
    vector<Real*> Poisson::localCellParams;
    bool Poisson::timeDependentBackground = false;
+   int Poisson::extrapolationOrder = 1;
+   int Poisson::historyLength = 0;
+   Real Poisson::solutionTimes[3] = {0.0,0.0,0.0};
+   uint Poisson::lastIterations = 0;
+   Real Poisson::lastMaxError = -1.0;
+
+   /** Calculate Lagrange extrapolation weights of the stored potentials 
+    * PHI, PHI_OLD1, PHI_OLD2 at time t.
+    * @param order Extrapolation order, at most Poisson::historyLength-1.
+    * @param t Time of the new solution.
+    * @param weights Weights of the stored potentials, written by this function.*/
+   static void extrapolationWeights(const int& order,const Real& t,Real weights[3]) {
+      for (int i=0; i<3; ++i) weights[i] = 0.0;
+      for (int i=0; i<=order; ++i) {
+         weights[i] = 1.0;
+         for (int j=0; j<=order; ++j) {
+            if (j == i) continue;
+            weights[i] *= (t - Poisson::solutionTimes[j]) / (Poisson::solutionTimes[i] - Poisson::solutionTimes[j]);
+         }
+      }
+   }
 
    void Poisson::cacheCellParameters(dccrg::Dccrg<spatial_cell::SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
 				     const std::vector<CellID>& cells) {
@@ -98,7 +120,9 @@ namespace poisson {
 
       phiprof::start("Background Field");
 
-      if (Poisson::clearPotential == true || Parameters::tstep == 0 || Parameters::meshRepartitioned == true) {
+      // Potential migrates with the cells, so it is not cleared after repartitioning
+      if (Poisson::clearPotential == true || Parameters::tstep == 0) {
+         Poisson::historyLength = 0;
          #pragma omp parallel for
          for (size_t c=0; c<cells.size(); ++c) {
             spatial_cell::SpatialCell* cell = mpiGrid[cells[c]];
@@ -114,6 +138,14 @@ namespace poisson {
             cell->parameters[CellParams::EZVOL] = cell->parameters[CellParams::BGEZVOL];
          }
       } else {
+         // Extrapolate the initial guess from previous solutions and push 
+         // the latest solution to history. If solving again at the time of 
+         // the latest solution, it is used as is.
+         const bool newTime = (Poisson::historyLength > 0 && Poisson::solutionTimes[0] != Parameters::t);
+         const int order = max(0,min(Poisson::extrapolationOrder,Poisson::historyLength-1));
+         Real w[3];
+         extrapolationWeights(order,Parameters::t,w);
+
          #pragma omp parallel for
          for (size_t c=0; c<cells.size(); ++c) {
             spatial_cell::SpatialCell* cell = mpiGrid[cells[c]];
@@ -122,6 +154,14 @@ namespace poisson {
                getObjectWrapper().project->setCellBackgroundField(cell);
             }
 
+            if (newTime == true) {
+               Real* cp = cell->parameters;
+               const Real guess = w[0]*cp[CellParams::PHI] + w[1]*cp[CellParams::PHI_OLD1] + w[2]*cp[CellParams::PHI_OLD2];
+               cp[CellParams::PHI_OLD2] = cp[CellParams::PHI_OLD1];
+               cp[CellParams::PHI_OLD1] = cp[CellParams::PHI];
+               cp[CellParams::PHI] = guess;
+            }
+
             cell->parameters[CellParams::EXVOL] = cell->parameters[CellParams::BGEXVOL];
             cell->parameters[CellParams::EYVOL] = cell->parameters[CellParams::BGEYVOL];
             cell->parameters[CellParams::EZVOL] = cell->parameters[CellParams::BGEZVOL];
@@ -131,90 +171,21 @@ namespace poisson {
       return true;
    }
 
+   /** Calculate total charge density on given spatial cell. The charge density 
+    * of particle populations is accumulated in the velocity moment calculation 
+    * to CellParams::RHOQ, so the distribution function is not read here.
+    * @param cell Spatial cell.*/
    void PoissonSolver::calculateChargeDensitySingle(spatial_cell::SpatialCell* cell) {
-      Real rho_q = 0.0;
-      // Iterate all particle species
-      for (int popID=0; popID<getObjectWrapper().particleSpecies.size(); ++popID) {
-         Real rho_q_spec=0;
-         vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer = cell->get_velocity_blocks(popID);
-         if (blockContainer.size() == 0) continue;
-
-         const Real charge       = getObjectWrapper().particleSpecies[popID].charge;
-         const Realf* data       = blockContainer.getData();
-         const Real* blockParams = blockContainer.getParameters();
-
-         // Sum charge density over all phase-space cells
-         for (vmesh::LocalID blockLID=0; blockLID<blockContainer.size(); ++blockLID) {
-            Real sum = 0.0;
-            for (int i=0; i<WID3; ++i) sum += data[blockLID*WID3+i];
-
-            const Real DV3 
-               = blockParams[blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS+BlockParams::DVX]
-               * blockParams[blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS+BlockParams::DVY]
-               * blockParams[blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS+BlockParams::DVZ];
-            rho_q_spec += sum*DV3;
-         }
-         
-         rho_q += charge*rho_q_spec;
-      } // for-loop over particle species
-
-      cell->parameters[CellParams::RHOQ_TOT] = cell->parameters[CellParams::RHOQ_EXT] + rho_q/physicalconstants::EPS_0;
+      cell->parameters[CellParams::RHOQ_TOT] 
+         = cell->parameters[CellParams::RHOQ_EXT] + cell->parameters[CellParams::RHOQ]/physicalconstants::EPS_0;
    }
    
-   /** Calculate total charge density on given spatial cells.
-    * @param mpiGrid Parallel grid library.
-    * @param cells List of spatial cells.
-    * @return If true, charge densities were successfully calculated.*/
+   /** Calculate total charge density on given spatial cell.
+    * @param cell Spatial cell.
+    * @return If true, charge density was successfully calculated.*/
    bool PoissonSolver::calculateChargeDensity(spatial_cell::SpatialCell* cell) {
-      phiprof::start("Charge Density");
       bool success = true;
-
-      Real rho_q = 0.0;
-      #pragma omp parallel reduction (+:rho_q)
-      {
-         // Iterate all particle species
-         for (int popID=0; popID<getObjectWrapper().particleSpecies.size(); ++popID) {
-            Real rho_q_spec=0;
-            vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer = cell->get_velocity_blocks(popID);
-            if (blockContainer.size() == 0) continue;
-
-            const Real charge       = getObjectWrapper().particleSpecies[popID].charge;
-            const Realf* data       = blockContainer.getData();
-            const Real* blockParams = blockContainer.getParameters();
-
-            // Sum charge density over all phase-space cells
-            #pragma omp for
-            for (vmesh::LocalID blockLID=0; blockLID<blockContainer.size(); ++blockLID) {
-               Real sum = 0.0;
-               for (int i=0; i<WID3; ++i) sum += data[blockLID*WID3+i];
-
-               const Real DV3 
-                  = blockParams[blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS+BlockParams::DVX]
-                  * blockParams[blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS+BlockParams::DVY]
-                  * blockParams[blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS+BlockParams::DVZ];
-               rho_q_spec += sum*DV3;
-            }
-
-            #ifdef DEBUG_POISSON
-            bool ok = true;
-            if (rho_q_spec != rho_q_spec) ok = false;
-            if (rho_q != rho_q) ok = false;
-            if (charge != charge) ok = false;
-            if (ok == false) {
-               stringstream ss;
-               ss << "(POISSON SOLVER) NAN detected, rho_q: " << rho_q_spec << '\t' << rho_q << '\t';
-               ss << "pop " << popID << " charge: " << charge << '\t';
-               ss << endl;
-               cerr << ss.str();
-               exit(1);
-            }
-            #endif
-            
-            rho_q += charge*rho_q_spec;
-         } // for-loop over particle species
-      }
-
-      cell->parameters[CellParams::RHOQ_TOT] = cell->parameters[CellParams::RHOQ_EXT] + rho_q/physicalconstants::EPS_0;
+      const Real rho_q = cell->parameters[CellParams::RHOQ];
 
       #ifdef DEBUG_POISSON
       bool ok = true;
@@ -226,12 +197,8 @@ namespace poisson {
          cerr << ss.str(); exit(1);
       }
       #endif
-      
-      size_t phaseSpaceCells=0;
-      for (int popID=0; popID<getObjectWrapper().particleSpecies.size(); ++popID)
-         phaseSpaceCells += cell->get_velocity_blocks(popID).size()*WID3;
 
-      phiprof::stop("Charge Density",phaseSpaceCells,"Phase-space cells");
+      cell->parameters[CellParams::RHOQ_TOT] = cell->parameters[CellParams::RHOQ_EXT] + rho_q/physicalconstants::EPS_0;
       return success;
    }
 
@@ -422,6 +389,7 @@ namespace poisson {
            logFile << "Parameters are:" << endl;
            logFile << "\t max absolute error: " << Poisson::maxAbsoluteError << endl;
            logFile << "\t max iterations    : " << Poisson::maxIterations << endl;
+           logFile << "\t extrapolation ord : " << Poisson::extrapolationOrder << endl;
            logFile << "\t time dep bground  : ";
            if (Poisson::timeDependentBackground == true) logFile << "Yes" << endl;
            else logFile << "No" << endl;
@@ -443,6 +411,8 @@ namespace poisson {
 
       for (size_t c=0; c<getLocalCells().size(); ++c) {
          spatial_cell::SpatialCell* cell = mpiGrid[getLocalCells()[c]];
+         // Moments are read from the restart file, charge density is not
+         if (Parameters::isRestart == true) calculateCellChargeDensity(cell);
          if (Poisson::solver->calculateChargeDensity(cell) == false) {
             logFile << "(POISSON SOLVER) ERROR: Failed to calculate charge density in " << __FILE__ << ":" << __LINE__ << endl << write;
             success = false;
@@ -496,6 +466,17 @@ namespace poisson {
          mpiGrid.update_copies_of_remote_neighbors(POISSON_NEIGHBORHOOD_ID);
 
          if (Poisson::solver->solve(mpiGrid) == false) success = false;
+
+         // Store the time of the new solution, see calculateBackgroundField
+         if (Poisson::historyLength == 0 || Poisson::solutionTimes[0] != Parameters::t) {
+            Poisson::solutionTimes[2] = Poisson::solutionTimes[1];
+            Poisson::solutionTimes[1] = Poisson::solutionTimes[0];
+            Poisson::historyLength = min(Poisson::historyLength+1,3);
+         }
+         Poisson::solutionTimes[0] = Parameters::t;
+
+         logFile << "(POISSON SOLVER) tstep " << Parameters::tstep << " t " << Parameters::t;
+         logFile << " iterations " << Poisson::lastIterations << " max error " << Poisson::lastMaxError << endl << writeVerbose;
       }
 
       // Add electrostatic electric field to volume-averaged E
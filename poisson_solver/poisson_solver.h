@@ -126,6 +126,13 @@ namespace poisson {
 						    * is the same as in getLocalCells() vector.*/
       static bool timeDependentBackground;         /**< If true, the background field / charge density is 
                                                     * time-dependent and must be recalculated each time step.*/
+      static int extrapolationOrder;               /**< Initial guess of the potential is extrapolated in time 
+                                                    * from this many previous solutions (0 = use previous potential, 
+                                                    * 1 = linear, 2 = quadratic).*/
+      static int historyLength;                    /**< Number of stored solutions in PHI, PHI_OLD1, PHI_OLD2.*/
+      static Real solutionTimes[3];                /**< Simulation times of the stored solutions, newest first.*/
+      static uint lastIterations;                  /**< Number of iterations taken by the latest solve.*/
+      static Real lastMaxError;                    /**< Maximum error of the latest solve, negative if not evaluated.*/
       
       static void cacheCellParameters(dccrg::Dccrg<spatial_cell::SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
 				      const std::vector<CellID>& cells);
@@ -479,6 +479,8 @@ namespace poisson {
          if (iterations >= Poisson::maxIterations) break;
          if (globalVariables[cgglobal::R_MAX] < Poisson::maxAbsoluteError) break;
       } while (true);      
+      Poisson::lastIterations = iterations;
+      Poisson::lastMaxError = globalVariables[cgglobal::R_MAX];
 
       if (calculateElectrostaticField(mpiGrid) == false) {
          logFile << "(POISSON SOLVER CG) ERROR: Failed to calculate electrostatic field in ";
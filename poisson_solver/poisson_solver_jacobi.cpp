@@ -125,6 +125,8 @@ namespace poisson {
          // Evaluate the error in potential solution and reiterate if necessary         
          break;
       } while (true);
+      Poisson::lastIterations = 1;
+      Poisson::lastMaxError = -1.0;
 
       phiprof::stop("Poisson Solver");
 
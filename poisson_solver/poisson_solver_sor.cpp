@@ -552,6 +552,8 @@ namespace poisson {
          //if (relPotentialChange <= Poisson::minRelativePotentialChange) break;
          if (iterations >= Poisson::maxIterations) break;
       } while (true);
+      Poisson::lastIterations = iterations;
+      Poisson::lastMaxError = maxError;
 
       if (calculateElectrostaticField(mpiGrid) == false) success = false;
       return success;
@@ -68,6 +68,7 @@ namespace projects {
       RP::add("ElectricSail.min_relative_change","Potential is iterated until it the relative change is less than this value",(Real)1e-5);
       RP::add("ElectricSail.clear_potential","Clear potential each timestep before solving Poisson?",true);
       RP::add("ElectricSail.is_2D","If true then system is two-dimensional in xy-plane",true);
+      RP::add("ElectricSail.extrapolation_order","Initial guess of the potential is extrapolated from this many previous solutions (0-2)",1);
       RP::add("ElectricSail.tether_x","Electric sail tether x-position",(Real)0.0);
       RP::add("ElectricSail.tether_y","Electric sail tether y-position",(Real)0.0);
       RP::add("ElectricSail.max_absolute_error","Maximum absolute error allowed in Poisson solution",(Real)1e-4);
@@ -132,6 +133,7 @@ namespace projects {
       RP::get("ElectricSail.max_iterations",poisson::Poisson::maxIterations);
       RP::get("ElectricSail.min_relative_change",poisson::Poisson::minRelativePotentialChange);
       RP::get("ElectricSail.is_2D",poisson::Poisson::is2D);
+      RP::get("ElectricSail.extrapolation_order",poisson::Poisson::extrapolationOrder);
       RP::get("ElectricSail.clear_potential",poisson::Poisson::clearPotential);
       RP::get("ElectricSail.tether_x",tether_x);
       RP::get("ElectricSail.tether_y",tether_y);
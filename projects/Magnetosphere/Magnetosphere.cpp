@@ -178,6 +178,9 @@ namespace projects {
    Real Magnetosphere::calcPhaseSpaceDensity(creal& x,creal& y,creal& z,creal& dx,creal& dy,creal& dz,
                                              creal& vx,creal& vy,creal& vz,creal& dvx,creal& dvy,
                                              creal& dvz,const int& popID) const {
+      if (adaptiveSamplingEnabled()) {
+         return adaptivePhaseSpaceDensity(x,y,z,dx,dy,dz,vx,vy,vz,dvx,dvy,dvz,popID,this->nSpaceSamples);
+      }
       if((this->nSpaceSamples > 1) && (this->nVelocitySamples > 1)) {
          creal d_x = dx / (this->nSpaceSamples-1);
          creal d_y = dy / (this->nSpaceSamples-1);
@@ -205,6 +208,12 @@ namespace projects {
       }
    }
    
+   Real Magnetosphere::probePhaseSpaceDensity(creal& x,creal& y,creal& z,
+                                              creal& vx,creal& vy,creal& vz,
+                                              creal& dvx,creal& dvy,creal& dvz,const int& popID) const {
+      return getDistribValue(x,y,z,vx,vy,vz,dvx,dvy,dvz);
+   }
+   
    /*! Magnetosphere does not set any extra perturbed B. */
    void Magnetosphere::calcCellParameters(spatial_cell::SpatialCell* cell,creal& t) {
       Real* cellParams = cell->get_cell_parameters();
@@ -45,6 +45,12 @@ namespace projects {
                                         ) const;
       
     protected:
+      virtual Real probePhaseSpaceDensity(
+                                          creal& x, creal& y, creal& z,
+                                          creal& vx, creal& vy, creal& vz,
+                                          creal& dvx, creal& dvy, creal& dvz,
+                                          const int& popID
+                                         ) const;
       Real getDistribValue(
                            creal& x,creal& y, creal& z,
                            creal& vx, creal& vy, creal& vz,
@@ -51,6 +51,7 @@ namespace projects {
       RP::add("Poisson.max_iterations","Maximum number of iterations",(uint)1000);
       RP::add("Poisson.min_relative_change","Potential is iterated until it the relative change is less than this value",(Real)1e-5);
       RP::add("Poisson.is_2D","If true then system is two-dimensional in xy-plane",true);
+      RP::add("Poisson.extrapolation_order","Initial guess of the potential is extrapolated from this many previous solutions (0-2)",1);
    }
 
    void PoissonTest::getParameters() {
@@ -60,6 +61,7 @@ namespace projects {
       RP::get("Poisson.max_iterations",poisson::Poisson::maxIterations);
       RP::get("Poisson.min_relative_change",poisson::Poisson::minRelativePotentialChange);
       RP::get("Poisson.is_2D",poisson::Poisson::is2D);
+      RP::get("Poisson.extrapolation_order",poisson::Poisson::extrapolationOrder);
    }
 
    bool PoissonTest::initialize() {
@@ -22,6 +22,7 @@
 
 #include "project.h"
 #include <cstdlib>
+#include <cmath>
 #include "../common.h"
 #include "../parameters.h"
 #include "../readparameters.h"
@@ -78,6 +79,9 @@ struct VelocityMeshParams {
    vector<double> vy_length;
    vector<double> vz_length;
    vector<unsigned int> maxRefLevels;
+   vector<double> vx_stretch;
+   vector<double> vy_stretch;
+   vector<double> vz_stretch;
    
    void resize(const size_t& size) {
       name.resize(1);
@@ -99,6 +103,8 @@ static VelocityMeshParams* velMeshParams = NULL;
 namespace projects {
    Project::Project() { 
       baseClassInitialized = false;
+      adaptiveSamplingTolerance = 0.0;
+      adaptiveSamplingMaxLevel = 0;
    }
    
    Project::~Project() { }
@@ -130,6 +136,8 @@ namespace projects {
       projects::Shocktest::addParameters();
       projects::PoissonTest::addParameters();
       RP::add("Project_common.seed", "Seed for the RNG", 42);
+      RP::add("Project_common.adaptive_sampling_tolerance", "Relative error tolerance for adaptive sampling of the initial distribution function in projects that support it, 0 uses the projects' fixed sampling (Real)", 0.0);
+      RP::add("Project_common.adaptive_sampling_max_level", "Maximum number of times a velocity cell is split into octants in adaptive sampling (int)", 3);
       
       // Add parameters needed to create particle populations
       RP::addComposing("ParticlePopulation.name","Name of the simulated particle population (string)");
@@ -138,6 +146,9 @@ namespace projects {
       RP::addComposing("ParticlePopulation.mass","Particle mass in given units (float)");
       RP::addComposing("ParticlePopulation.sparse_min_value","Minimum value of distribution function in any cell of a velocity block for the block to be considered to have content");
       RP::addComposing("ParticlePopulation.mesh","Name of the velocity mesh the species should use (string)");
+      RP::addComposing("ParticlePopulation.max_speed","(optional) Velocity blocks are not created beyond this speed, m/s. Zero or negative disables the ceiling (float)");
+      RP::addComposing("ParticlePopulation.max_speed_relative","(optional) If 1, max_speed is measured from the local bulk velocity (int)");
+      RP::addComposing("ParticlePopulation.max_speed_thermal_factor","(optional) Multiple of the local rms thermal speed added to a relative max_speed (float)");
       
       // Add parameters needed to create velocity meshes
       RP::addComposing("velocitymesh.name","Name of the mesh (unique,string)");
@@ -151,6 +162,9 @@ namespace projects {
       RP::addComposing("velocitymesh.vy_length","Initial number of velocity blocks in vy-direction.");
       RP::addComposing("velocitymesh.vz_length","Initial number of velocity blocks in vz-direction.");
       RP::addComposing("velocitymesh.max_refinement_level","Maximum allowed mesh refinement level.");
+      RP::addComposing("velocitymesh.vx_stretch","(optional) Width ratio of adjacent blocks in vx-direction, blocks widen away from the mesh centre. 1 = uniform mesh.");
+      RP::addComposing("velocitymesh.vy_stretch","(optional) Width ratio of adjacent blocks in vy-direction, blocks widen away from the mesh centre. 1 = uniform mesh.");
+      RP::addComposing("velocitymesh.vz_stretch","(optional) Width ratio of adjacent blocks in vz-direction, blocks widen away from the mesh centre. 1 = uniform mesh.");
 
       // These parameters are only read if the 'velocitymesh.' parameters are not defined 
       // in order to support older configuration files.
@@ -169,12 +183,17 @@ namespace projects {
    void Project::getParameters() {
       typedef Readparameters RP;
       RP::get("Project_common.seed", this->seed);
+      RP::get("Project_common.adaptive_sampling_tolerance", this->adaptiveSamplingTolerance);
+      RP::get("Project_common.adaptive_sampling_max_level", this->adaptiveSamplingMaxLevel);
       RP::get("ParticlePopulation.name",popNames);
       RP::get("ParticlePopulation.charge",popCharges);
       RP::get("ParticlePopulation.mass_units",popMassUnits);
       RP::get("ParticlePopulation.mass",popMasses);
       RP::get("ParticlePopulation.sparse_min_value",popSparseMinValue);
       RP::get("ParticlePopulation.mesh",popMeshNames);
+      RP::get("ParticlePopulation.max_speed",popMaxSpeed);
+      RP::get("ParticlePopulation.max_speed_relative",popMaxSpeedRelative);
+      RP::get("ParticlePopulation.max_speed_thermal_factor",popMaxSpeedThermalFactor);
 
       if (velMeshParams == NULL) velMeshParams = new VelocityMeshParams();
       RP::get("velocitymesh.name",velMeshParams->name);
@@ -188,6 +207,9 @@ namespace projects {
       RP::get("velocitymesh.vy_length",velMeshParams->vy_length);
       RP::get("velocitymesh.vz_length",velMeshParams->vz_length);
       RP::get("velocitymesh.max_refinement_level",velMeshParams->maxRefLevels);
+      RP::get("velocitymesh.vx_stretch",velMeshParams->vx_stretch);
+      RP::get("velocitymesh.vy_stretch",velMeshParams->vy_stretch);
+      RP::get("velocitymesh.vz_stretch",velMeshParams->vz_stretch);
    }
 
    /** Initialize the Project. Velocity mesh and particle population 
@@ -205,13 +227,17 @@ namespace projects {
       if (popNames.size() != popMasses.size()) success = false;
       if (popNames.size() != popSparseMinValue.size()) success = false;
       if (popNames.size() != popMeshNames.size()) success = false;
+      if (popMaxSpeed.size() != 0 && popNames.size() != popMaxSpeed.size()) success = false;
+      if (popMaxSpeedRelative.size() != 0 && popNames.size() != popMaxSpeedRelative.size()) success = false;
+      if (popMaxSpeedThermalFactor.size() != 0 && popNames.size() != popMaxSpeedThermalFactor.size()) success = false;
       if (success == false) {
          stringstream ss;
          ss << "(PROJECT) ERROR in configuration file particle population definitions at ";
          ss << __FILE__ << ":" << __LINE__ << endl;
          ss << "\t vector sizes are: " << popNames.size() << ' ' << popMassUnits.size();
          ss << ' ' << popMasses.size() << ' ' << popSparseMinValue.size() << ' ';
-         ss << popMeshNames.size() << endl;
+         ss << popMeshNames.size() << ' ' << popMaxSpeed.size() << ' ' << popMaxSpeedRelative.size() << ' ';
+         ss << popMaxSpeedThermalFactor.size() << endl;
          cerr << ss.str(); return success;
       }
 
@@ -225,6 +251,9 @@ namespace projects {
       if (velMeshParams->vy_length.size() != velMeshParams->name.size()) success = false;
       if (velMeshParams->vz_length.size() != velMeshParams->name.size()) success = false;
       if (velMeshParams->maxRefLevels.size() != velMeshParams->name.size()) success = false;
+      if (velMeshParams->vx_stretch.size() != 0 && velMeshParams->vx_stretch.size() != velMeshParams->name.size()) success = false;
+      if (velMeshParams->vy_stretch.size() != 0 && velMeshParams->vy_stretch.size() != velMeshParams->name.size()) success = false;
+      if (velMeshParams->vz_stretch.size() != 0 && velMeshParams->vz_stretch.size() != velMeshParams->name.size()) success = false;
       if (success == false) {
          stringstream ss;
          ss << "(PROJECT) ERROR in configuration file velocity mesh definitions at ";
@@ -286,6 +315,34 @@ namespace projects {
          meshParams.blockLength[1] = WID;
          meshParams.blockLength[2] = WID;
          meshParams.refLevelMaxAllowed = velMeshParams->maxRefLevels[m];
+         if (velMeshParams->vx_stretch.size() > 0) meshParams.stretchFactor[0] = velMeshParams->vx_stretch[m];
+         if (velMeshParams->vy_stretch.size() > 0) meshParams.stretchFactor[1] = velMeshParams->vy_stretch[m];
+         if (velMeshParams->vz_stretch.size() > 0) meshParams.stretchFactor[2] = velMeshParams->vz_stretch[m];
+         
+         bool validStretch = true;
+         for (int i=0; i<3; ++i) {
+            if (meshParams.stretchFactor[i] <= 0.0) validStretch = false;
+         }
+         if (validStretch == false) {
+            stringstream ss;
+            ss << "(PROJECT) ERROR: Velocity mesh '" << meshParams.name << "' has a non-positive stretch factor in ";
+            ss << __FILE__ << ":" << __LINE__ << endl;
+            cerr << ss.str(); success = false;
+            continue;
+         }
+         #ifdef AMR
+         bool stretched = false;
+         for (int i=0; i<3; ++i) {
+            if (meshParams.stretchFactor[i] != 1.0) stretched = true;
+         }
+         if (stretched == true) {
+            stringstream ss;
+            ss << "(PROJECT) ERROR: Stretched velocity mesh '" << meshParams.name << "' is not supported by the AMR velocity mesh in ";
+            ss << __FILE__ << ":" << __LINE__ << endl;
+            cerr << ss.str(); success = false;
+            continue;
+         }
+         #endif
          owrapper.velocityMeshes.push_back(meshParams);
       }
 
@@ -343,6 +400,9 @@ namespace projects {
          }
          population.mass = massUnits*popMasses[p];
          population.sparseMinValue = popSparseMinValue[p];
+         if (popMaxSpeed.size() > 0) population.maxSpeed = popMaxSpeed[p];
+         if (popMaxSpeedRelative.size() > 0) population.maxSpeedRelative = (popMaxSpeedRelative[p] != 0);
+         if (popMaxSpeedThermalFactor.size() > 0) population.maxSpeedThermalFactor = popMaxSpeedThermalFactor[p];
          
          bool meshFound = false;
          for (size_t m=0; m<owrapper.velocityMeshes.size(); ++m) {
@@ -444,6 +504,13 @@ namespace projects {
          logFile << "\t charge           : '" << spec.charge << "'" << endl;
          logFile << "\t mass             : '" << spec.mass << "'" << endl;
          logFile << "\t sparse threshold : '" << spec.sparseMinValue << "'" << endl;
+         if (spec.maxSpeed > 0) {
+            logFile << "\t max speed        : '" << spec.maxSpeed << "'";
+            if (spec.maxSpeedRelative) {
+               logFile << " relative to bulk velocity, plus " << spec.maxSpeedThermalFactor << " thermal speeds";
+            }
+            logFile << endl;
+         }
          logFile << "\t velocity mesh    : '" << getObjectWrapper().velocityMeshes[spec.velocityMesh].name << "'" << endl;
          logFile << endl;
       }
@@ -654,6 +721,105 @@ namespace projects {
       return -1.0;
    }
 
+   Real Project::probePhaseSpaceDensity(
+      creal& x, creal& y, creal& z,
+      creal& vx, creal& vy, creal& vz,
+      creal& dvx, creal& dvy, creal& dvz,
+      const int& popID) const {
+      cerr << "ERROR: Project::probePhaseSpaceDensity called instead of derived class function!" << endl;
+      exit(1);
+      return -1.0;
+   }
+
+   bool Project::adaptiveSamplingEnabled() const {
+      return adaptiveSamplingTolerance > 0.0;
+   }
+
+   Real Project::adaptivePhaseSpaceDensity(
+      creal& x, creal& y, creal& z,
+      creal& dx, creal& dy, creal& dz,
+      creal& vx, creal& vy, creal& vz,
+      creal& dvx, creal& dvy, creal& dvz,
+      const int& popID,const uint& nSpaceSamples) const {
+
+      // Values below a fraction of the sparsity threshold are removed
+      // anyway, so there is no point in resolving them accurately
+      creal absTolerance = adaptiveSamplingTolerance*getObjectWrapper().particleSpecies[popID].sparseMinValue;
+
+      if (nSpaceSamples <= 1) {
+         return adaptiveVelocityAverage(x+0.5*dx,y+0.5*dy,z+0.5*dz,vx,vy,vz,dvx,dvy,dvz,
+                                        dvx,dvy,dvz,popID,absTolerance,0);
+      }
+
+      creal d_x = dx / (nSpaceSamples-1);
+      creal d_y = dy / (nSpaceSamples-1);
+      creal d_z = dz / (nSpaceSamples-1);
+      Real avg = 0.0;
+      for (uint i=0; i<nSpaceSamples; ++i)
+         for (uint j=0; j<nSpaceSamples; ++j)
+            for (uint k=0; k<nSpaceSamples; ++k) {
+               avg += adaptiveVelocityAverage(x+i*d_x,y+j*d_y,z+k*d_z,vx,vy,vz,dvx,dvy,dvz,
+                                              dvx,dvy,dvz,popID,absTolerance,0);
+            }
+      return avg / (nSpaceSamples*nSpaceSamples*nSpaceSamples);
+   }
+
+   /** Average of the distribution function over the velocity box [vx,vx+dvx] x [vy,vy+dvy] x [vz,vz+dvz]
+    * at the spatial point (x,y,z). Along each velocity axis the distribution function is sampled at
+    * quarter and half box widths from the centre, which gives the second and fourth derivatives and an
+    * average that is exact for quartic functions of each coordinate. The fourth-order part of the
+    * correction is used as the error estimate, and if it exceeds the tolerance the box is split into octants.*/
+   Real Project::adaptiveVelocityAverage(
+      creal& x, creal& y, creal& z,
+      creal& vx, creal& vy, creal& vz,
+      creal& dvx, creal& dvy, creal& dvz,
+      creal& cellDvx, creal& cellDvy, creal& cellDvz,
+      const int& popID,creal& absTolerance,const uint& level) const {
+
+      creal vCenter[3] = {vx+0.5*dvx,vy+0.5*dvy,vz+0.5*dvz};
+      creal dv[3] = {dvx,dvy,dvz};
+      creal center = probePhaseSpaceDensity(x,y,z,vCenter[0],vCenter[1],vCenter[2],cellDvx,cellDvy,cellDvz,popID);
+
+      Real estimate = center;
+      Real error = 0.0;
+      for (uint dim=0; dim<3; ++dim) {
+         Real quarter = -2*center;
+         Real half = -2*center;
+         for (int sign=-1; sign<=1; sign+=2) {
+            Real v[3] = {vCenter[0],vCenter[1],vCenter[2]};
+            v[dim] += sign*0.25*dv[dim];
+            quarter += probePhaseSpaceDensity(x,y,z,v[0],v[1],v[2],cellDvx,cellDvy,cellDvz,popID);
+            v[dim] += sign*0.25*dv[dim];
+            half += probePhaseSpaceDensity(x,y,z,v[0],v[1],v[2],cellDvx,cellDvy,cellDvz,popID);
+         }
+         // With h = dv[dim] the second differences are quarter = f''h^2/16 + f''''h^4/3072
+         // and half = f''h^2/4 + f''''h^4/192, and the box average of the Taylor
+         // series is f0 + f''h^2/24 + f''''h^4/1920
+         creal d4 = 256*(half - 4*quarter);
+         creal d2 = 16*quarter - d4/192;
+         estimate += d2/24 + d4/1920;
+         error += fabs(d4)/1920;
+      }
+
+      if (level >= adaptiveSamplingMaxLevel
+          || error <= absTolerance
+          || error <= adaptiveSamplingTolerance*fabs(estimate)) {
+         return max(estimate,(Real)0.0);
+      }
+
+      creal hx = 0.5*dvx;
+      creal hy = 0.5*dvy;
+      creal hz = 0.5*dvz;
+      Real avg = 0.0;
+      for (uint i=0; i<2; ++i)
+         for (uint j=0; j<2; ++j)
+            for (uint k=0; k<2; ++k) {
+               avg += adaptiveVelocityAverage(x,y,z,vx+i*hx,vy+j*hy,vz+k*hz,hx,hy,hz,
+                                              cellDvx,cellDvy,cellDvz,popID,absTolerance,level+1);
+            }
+      return 0.125*avg;
+   }
+
    /*!
      Get random number between 0 and 1.0. One should always first initialize the rng.
    */
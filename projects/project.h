@@ -120,6 +120,40 @@ namespace projects {
                                          creal& vx, creal& vy, creal& vz,
                                          creal& dvx, creal& dvy, creal& dvz,
                                          const int& popID) const;
+
+      /** Value of the distribution function at a single phase-space point. Projects that
+       * use adaptivePhaseSpaceDensity must implement this, the base class version aborts.
+       * NOTE: This function is called inside parallel region so it must be declared as const.
+       * @param x, y, z Spatial coordinates of the point.
+       * @param vx, vy, vz Velocity coordinates of the point.
+       * @param dvx, dvy, dvz Size of the velocity cell the point belongs to.
+       * @param popID Particle species ID.
+       * @return Value of the distribution function at the point.*/
+      virtual Real probePhaseSpaceDensity(
+                                          creal& x, creal& y, creal& z,
+                                          creal& vx, creal& vy, creal& vz,
+                                          creal& dvx, creal& dvy, creal& dvz,
+                                          const int& popID) const;
+
+      /** If true, projects should compute calcPhaseSpaceDensity with adaptivePhaseSpaceDensity
+       * instead of a fixed number of velocity samples.*/
+      bool adaptiveSamplingEnabled() const;
+
+      /** Error-controlled volume average of the distribution function over a phase-space cell.
+       * The spatial cell is sampled on nSpaceSamples^3 points like in the projects' own
+       * sampling loops. In velocity space the average starts from the value at the cell centre,
+       * and the cell is split into octants only where the fourth-order Taylor terms of the
+       * distribution function indicate that the centre value is not accurate enough.
+       * NOTE: This function is called inside parallel region so it must be declared as const.
+       * Parameters are as in calcPhaseSpaceDensity.
+       * @param nSpaceSamples Number of sampling points per spatial dimension.
+       * @return The volume average of the distribution function in the given phase space cell.*/
+      Real adaptivePhaseSpaceDensity(
+                                     creal& x, creal& y, creal& z,
+                                     creal& dx, creal& dy, creal& dz,
+                                     creal& vx, creal& vy, creal& vz,
+                                     creal& dvx, creal& dvy, creal& dvz,
+                                     const int& popID,const uint& nSpaceSamples) const;
       
       /*!
        Get random number between 0 and 1.0. One should always first initialize the rng.
@@ -147,7 +181,16 @@ namespace projects {
       void setRandomCellSeed(spatial_cell::SpatialCell* cell,const Real* const cellParams) const;
 
     private:
+      Real adaptiveVelocityAverage(
+                                   creal& x, creal& y, creal& z,
+                                   creal& vx, creal& vy, creal& vz,
+                                   creal& dvx, creal& dvy, creal& dvz,
+                                   creal& cellDvx, creal& cellDvy, creal& cellDvz,
+                                   const int& popID,creal& absTolerance,const uint& level) const;
+
       uint seed;
+      Real adaptiveSamplingTolerance;                 /**< Relative error tolerance of adaptive sampling, 0 disables it.*/
+      uint adaptiveSamplingMaxLevel;                  /**< Maximum number of octant splits of a velocity cell in adaptive sampling.*/
       static char rngStateBuffer[256];
       static random_data rngDataBuffer;
       #pragma omp threadprivate(rngStateBuffer,rngDataBuffer)
@@ -161,6 +204,9 @@ namespace projects {
                                                        * Read from configuration file.*/
       std::vector<std::string> popMeshNames;          /**< Name of the velocity mesh each species should use.*/
       std::vector<double> popSparseMinValue;          /**< Sparse mesh threshold value for the population.*/
+      std::vector<double> popMaxSpeed;                /**< Speed ceiling for velocity blocks (optional).*/
+      std::vector<int> popMaxSpeedRelative;           /**< If nonzero, speed ceiling is relative to bulk velocity (optional).*/
+      std::vector<double> popMaxSpeedThermalFactor;   /**< Multiple of thermal speed added to speed ceiling (optional).*/
    };
    
    Project* createProject();
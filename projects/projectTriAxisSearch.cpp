@@ -30,6 +30,7 @@ using namespace std;
 namespace projects {
    /*!
     * WARNING This assumes that the velocity space is isotropic (same resolution in vx, vy, vz).
+    * In stretched velocity meshes the searches step by the local block size.
     */
    std::vector<vmesh::GlobalID> TriAxisSearch::findBlocksToInitialize(SpatialCell* cell,const int& popID) const {
       set<vmesh::GlobalID> blocksToInitialize;
@@ -44,12 +45,6 @@ namespace projects {
       creal dz = cell->parameters[CellParams::DZ];
       
       const uint8_t refLevel = 0;
-      creal dvxCell = cell->get_velocity_grid_cell_size(popID,refLevel)[0];
-      creal dvyCell = cell->get_velocity_grid_cell_size(popID,refLevel)[1];
-      creal dvzCell = cell->get_velocity_grid_cell_size(popID,refLevel)[2];
-      creal dvxBlock = cell->get_velocity_grid_block_size(popID,refLevel)[0];
-      creal dvyBlock = cell->get_velocity_grid_block_size(popID,refLevel)[1];
-      creal dvzBlock = cell->get_velocity_grid_block_size(popID,refLevel)[2];
       
       const size_t vxblocks_ini = cell->get_velocity_grid_length(popID,refLevel)[0];
       const size_t vyblocks_ini = cell->get_velocity_grid_length(popID,refLevel)[1];
@@ -57,11 +52,18 @@ namespace projects {
 
       const vector<std::array<Real, 3>> V0 = this->getV0(x+0.5*dx, y+0.5*dy, z+0.5*dz);
       for (vector<std::array<Real, 3>>::const_iterator it = V0.begin(); it != V0.end(); it++) {
+         // The searches step by the size of the velocity block at the 
+         // search point, block sizes vary in stretched velocity meshes
+         Real V[3];
+         Real dvBlock[3];
+
          // VX search
          search = true;
          counter = 0;
+         V[0] = it->at(0); V[1] = it->at(1); V[2] = it->at(2);
          #warning TODO: add SpatialCell::getVelocityBlockMinValue() in place of sparseMinValue
          while (search) {
+            cell->get_velocity_block_size(popID,V,dvBlock);
             if (0.1 * getObjectWrapper().particleSpecies[popID].sparseMinValue >
                 calcPhaseSpaceDensity(x,
                                       y,
@@ -69,22 +71,25 @@ namespace projects {
                                       dx,
                                       dy,
                                       dz,
-                                      it->at(0) + counter*dvxBlock, it->at(1), it->at(2),
-                                      dvxCell, dvyCell, dvzCell, popID
+                                      V[0], V[1], V[2],
+                                      dvBlock[0]/WID, dvBlock[1]/WID, dvBlock[2]/WID, popID
                                      )
                ) {
                search = false;
             }
             ++counter;
+            V[0] += dvBlock[0];
             if (counter >= cell->get_velocity_grid_length(popID,refLevel)[0]) search = false;
          }
-         counter+=2;
-         Real vRadiusSquared = (Real)counter*(Real)counter*dvxBlock*dvxBlock;
+         V[0] += 2*dvBlock[0];
+         Real vRadiusSquared = (V[0]-it->at(0))*(V[0]-it->at(0));
 
          // VY search
          search = true;
          counter = 0;
+         V[0] = it->at(0); V[1] = it->at(1); V[2] = it->at(2);
          while(search) {
+            cell->get_velocity_block_size(popID,V,dvBlock);
             if (0.1 * getObjectWrapper().particleSpecies[popID].sparseMinValue >
                calcPhaseSpaceDensity(
                                      x,
@@ -93,8 +98,8 @@ namespace projects {
                                      dx,
                                      dy,
                                      dz,
-                                     it->at(0), it->at(1) + counter*dvyBlock, it->at(2),
-                                     dvxCell, dvyCell, dvzCell, popID
+                                     V[0], V[1], V[2],
+                                     dvBlock[0]/WID, dvBlock[1]/WID, dvBlock[2]/WID, popID
                                     )
                ||
                counter > vxblocks_ini
@@ -102,15 +107,18 @@ namespace projects {
                search = false;
             }
             ++counter;
+            V[1] += dvBlock[1];
             if (counter >= cell->get_velocity_grid_length(popID,refLevel)[1]) search = false;
          }
-         counter+=2;
-         vRadiusSquared = max(vRadiusSquared, (Real)counter*(Real)counter*dvyBlock*dvyBlock);
+         V[1] += 2*dvBlock[1];
+         vRadiusSquared = max(vRadiusSquared, (V[1]-it->at(1))*(V[1]-it->at(1)));
 
          // VZ search
          search = true;
          counter = 0;
+         V[0] = it->at(0); V[1] = it->at(1); V[2] = it->at(2);
          while(search) {
+            cell->get_velocity_block_size(popID,V,dvBlock);
             if (0.1 * getObjectWrapper().particleSpecies[popID].sparseMinValue >
                calcPhaseSpaceDensity(
                                      x,
@@ -119,8 +127,8 @@ namespace projects {
                                      dx,
                                      dy,
                                      dz,
-                                     it->at(0), it->at(1), it->at(2) + counter*dvzBlock,
-                                     dvxCell, dvyCell, dvzCell, popID
+                                     V[0], V[1], V[2],
+                                     dvBlock[0]/WID, dvBlock[1]/WID, dvBlock[2]/WID, popID
                                     )
                ||
                counter > vxblocks_ini
@@ -128,10 +136,11 @@ namespace projects {
                search = false;
             }
             ++counter;
+            V[2] += dvBlock[2];
             if (counter >= cell->get_velocity_grid_length(popID,refLevel)[2]) search = false;
          }
-         counter+=2;
-         vRadiusSquared = max(vRadiusSquared, (Real)counter*(Real)counter*dvzBlock*dvzBlock);
+         V[2] += 2*dvBlock[2];
+         vRadiusSquared = max(vRadiusSquared, (V[2]-it->at(2))*(V[2]-it->at(2)));
 
          // Block listing
          for (uint kv=0; kv<vzblocks_ini; ++kv) 
@@ -68,6 +68,8 @@ namespace spatial_cell {
          const species::Species& spec = getObjectWrapper().particleSpecies[popID];
          populations[popID].vmesh.initialize(spec.velocityMesh);
          populations[popID].velocityBlockMinValue = spec.sparseMinValue;
+         populations[popID].velocityBlockMinValueScale = 1.0;
+         populations[popID].blockMaxValuesValid = false;
       }
    }
 
@@ -99,6 +101,61 @@ namespace spatial_cell {
    }
 
 
+   /** Get the speed beyond which velocity blocks of the given population are 
+    * not kept in this cell. The ceiling is measured from referenceV, which is 
+    * either the origin or the bulk velocity of the cell. In the latter case 
+    * the configured multiple of the rms thermal speed is added to the ceiling. 
+    * Note that the bulk velocity and pressure are those of the cell, i.e., 
+    * summed over all populations.
+    * @param popID ID of the particle species.
+    * @param referenceV Reference velocity, written by this function.
+    * @return Speed ceiling, zero or negative if the ceiling is disabled.*/
+   Real SpatialCell::get_velocity_speed_ceiling(const int& popID,Real referenceV[3]) const {
+      const species::Species& spec = getObjectWrapper().particleSpecies[popID];
+      referenceV[0] = 0.0;
+      referenceV[1] = 0.0;
+      referenceV[2] = 0.0;
+      if (spec.maxSpeed <= 0.0) return spec.maxSpeed;
+      if (spec.maxSpeedRelative == false) return spec.maxSpeed;
+
+      const Real rho = parameters[CellParams::RHO];
+      if (rho <= 0.0) return spec.maxSpeed;
+      referenceV[0] = parameters[CellParams::RHOVX] / rho;
+      referenceV[1] = parameters[CellParams::RHOVY] / rho;
+      referenceV[2] = parameters[CellParams::RHOVZ] / rho;
+
+      // Pressure is in units of proton mass times number density (see cpu_moments), 
+      // which gives the rms thermal speed as sqrt(<dv^2>)
+      const Real P = parameters[CellParams::P_11] + parameters[CellParams::P_22] + parameters[CellParams::P_33];
+      Real v_th = 0.0;
+      if (P > 0.0) v_th = sqrt(P / (rho*physicalconstants::MASS_PROTON));
+      return spec.maxSpeed + spec.maxSpeedThermalFactor*v_th;
+   }
+
+   /** Check if the given velocity block lies entirely beyond the speed ceiling, 
+    * i.e., if the point of the block closest to referenceV is further than ceiling from it.
+    * @param popID ID of the particle species.
+    * @param blockGID Global ID of the velocity block.
+    * @param referenceV Reference velocity, given by get_velocity_speed_ceiling.
+    * @param ceiling Speed ceiling, given by get_velocity_speed_ceiling.
+    * @return If true, the block should not exist.*/
+   bool SpatialCell::velocity_block_is_beyond_speed_ceiling(const int& popID,const vmesh::GlobalID& blockGID,
+                                                            const Real referenceV[3],const Real& ceiling) {
+      Real coords[3];
+      Real size[3];
+      get_velocity_block_coordinates(popID,blockGID,coords);
+      get_velocity_block_size(popID,blockGID,size);
+
+      Real dist2 = 0.0;
+      for (int i=0; i<3; ++i) {
+         Real d = 0.0;
+         if (referenceV[i] < coords[i]) d = coords[i] - referenceV[i];
+         else if (referenceV[i] > coords[i]+size[i]) d = referenceV[i] - (coords[i]+size[i]);
+         dist2 += d*d;
+      }
+      return dist2 > ceiling*ceiling;
+   }
+
    /** Adds "important" and removes "unimportant" velocity blocks
     * to/from this cell.
     * 
@@ -119,6 +176,11 @@ namespace spatial_cell {
     * neighbouring cells, but these are not written to here. We only
     * modify local cell.
     * 
+    * If the population has a speed ceiling (see get_velocity_speed_ceiling), 
+    * blocks beyond it are not created, and if doDeleteEmptyBlocks is true, 
+    * existing blocks beyond it are removed even if they have content. The 
+    * removed mass is added to CellParams::RHOLOSSADJUST.
+    * 
     * NOTE: The AMR mesh must be valid, otherwise this function will
     * remove some blocks that should not be removed.*/
    #ifndef AMR
@@ -171,6 +233,19 @@ namespace spatial_cell {
          }
       }
 
+      // Do not create blocks beyond the speed ceiling of the population
+      Real referenceV[3];
+      const Real speedCeiling = get_velocity_speed_ceiling(popID,referenceV);
+      if (speedCeiling > 0.0) {
+         for (std::unordered_set<vmesh::GlobalID>::iterator it=neighbors_have_content.begin(); it != neighbors_have_content.end(); ) {
+            if (*it != invalid_global_id() && velocity_block_is_beyond_speed_ceiling(popID,*it,referenceV,speedCeiling)) {
+               it = neighbors_have_content.erase(it);
+            } else {
+               ++it;
+            }
+         }
+      }
+
       // REMOVE all blocks in this cell without content + without neighbors with content
       // better to do it in the reverse order, as then blocks at the
       // end are removed first, and we may avoid copying extra data.
@@ -210,12 +285,35 @@ namespace spatial_cell {
                this->remove_velocity_block(blockGID,popID);
             }
          }
+
+         // REMOVE blocks with content beyond the speed ceiling, and increment rho loss counters
+         if (speedCeiling > 0.0) {
+            for (int block_index=velocity_block_with_content_list.size()-1; block_index>=0; --block_index) {
+               const vmesh::GlobalID blockGID = velocity_block_with_content_list[block_index];
+               if (velocity_block_is_beyond_speed_ceiling(popID,blockGID,referenceV,speedCeiling) == false) continue;
+               const vmesh::LocalID blockLID = get_velocity_block_local_id(blockGID,popID);
+               if (blockLID == invalid_local_id()) continue;
+
+               const Real* block_parameters = get_block_parameters(popID)+blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS;
+               const Real DV3 = block_parameters[BlockParams::DVX]
+                 * block_parameters[BlockParams::DVY]
+                 * block_parameters[BlockParams::DVZ];
+               Real sum=0;
+               for (unsigned int i=0; i<WID3; ++i) sum += get_data(popID)[blockLID*SIZE_VELBLOCK+i];
+               this->parameters[CellParams::RHOLOSSADJUST] += DV3*sum;
+               this->remove_velocity_block(blockGID,popID);
+            }
+         }
       }
 
       // ADD all blocks with neighbors in spatial or velocity space (if it exists then the block is unchanged)
       for (std::unordered_set<vmesh::GlobalID>::iterator it=neighbors_have_content.begin(); it != neighbors_have_content.end(); ++it) {
          this->add_velocity_block(*it,popID);
       }
+
+      // Population has no blocks left (e.g. cell is outside the region it 
+      // occupies), release its storage until blocks are inserted again
+      if (populations[popID].vmesh.size() == 0) clear(popID);
    }
 
    #else       // AMR version
@@ -524,9 +622,10 @@ namespace spatial_cell {
     Returns true if given velocity block has enough of a distribution function.
     Returns false if the value of the distribution function is too low in every
     sense in given block.
-    Also returns false if given block doesn't exist or is an error block.
+    Also returns false if given block doesn't exist. The block is given by its 
+    local ID, callers iterate over local IDs so no global ID lookup is needed.
     */
-   bool SpatialCell::compute_block_has_content(const vmesh::GlobalID& blockGID,const int& popID) const {
+   bool SpatialCell::compute_block_has_content(const vmesh::LocalID& blockLID,const int& popID) const {
       #ifdef DEBUG_SPATIAL_CELL
       if (popID >= populations.size()) {
          std::cerr << "ERROR, popID " << popID << " exceeds populations.size() " << populations.size() << " in ";
@@ -535,9 +634,7 @@ namespace spatial_cell {
       }
       #endif
                                               
-      if (blockGID == invalid_global_id()) return false;
-      const vmesh::LocalID blockLID = get_velocity_block_local_id(blockGID,popID);
-      if (blockLID == invalid_local_id()) return false;
+      if (blockLID >= populations[popID].blockContainer.size()) return false;
             
       bool has_content = false;
       const Real velocity_block_min_value = getVelocityBlockMinValue(popID);
@@ -1283,6 +1380,12 @@ namespace spatial_cell {
     * have not been adapted to this new list. Here we re-initialize
     * the cell with empty blocks based on the new list.*/
    void SpatialCell::prepare_to_receive_blocks(const int& popID) {
+      // Remote copy of an empty population does not need any storage
+      if (populations[popID].vmesh.size() == 0) {
+         clear(popID);
+         return;
+      }
+
       populations[popID].vmesh.setGrid();
       populations[popID].blockContainer.setSize(populations[popID].vmesh.size());
 
@@ -1398,11 +1501,17 @@ namespace spatial_cell {
 
    /**  Purges extra capacity from block vectors. It sets size to
     * num_blocks * block_allocation_factor (if capacity greater than this), 
-    * and also forces capacity to this new smaller value.
+    * and also forces capacity to this new smaller value. All storage of 
+    * populations without blocks is released.
     * @return True on success.*/
    bool SpatialCell::shrink_to_fit() {
       bool success = true;
       for (size_t p=0; p<populations.size(); ++p) {
+         if (populations[p].vmesh.size() == 0) {
+            clear(p);
+            continue;
+         }
+
          const size_t amount 
             = 2 + populations[p].blockContainer.size() 
             * populations[p].blockContainer.getBlockAllocationFactor();
@@ -1415,6 +1524,8 @@ namespace spatial_cell {
    }
 
    /** Update the two lists containing blocks with content, and blocks without content.
+    * If the solver has left valid per-block maximum values (see get_velocity_block_max_values), 
+    * they are used instead of reading the block data.
     * @see adjustVelocityBlocks */
    void SpatialCell::update_velocity_block_content_lists(const int& popID) {
       #ifdef DEBUG_SPATIAL_CELL
@@ -1427,10 +1538,27 @@ namespace spatial_cell {
       
       velocity_block_with_content_list.clear();
       velocity_block_with_no_content_list.clear();
+
+      // Per-block maximum values are only valid until the distribution changes again
+      Population& pop = populations[popID];
+      const bool useMaxValues = pop.blockMaxValuesValid && pop.blockMaxValues.size() == pop.vmesh.size();
+      pop.blockMaxValuesValid = false;
+      if (useMaxValues) {
+         const Real velocity_block_min_value = getVelocityBlockMinValue(popID);
+         for (vmesh::LocalID block_index=0; block_index<pop.vmesh.size(); ++block_index) {
+            const vmesh::GlobalID globalID = pop.vmesh.getGlobalID(block_index);
+            if (pop.blockMaxValues[block_index] >= velocity_block_min_value) {
+               velocity_block_with_content_list.push_back(globalID);
+            } else {
+               velocity_block_with_no_content_list.push_back(globalID);
+            }
+         }
+         return;
+      }
       
       for (vmesh::LocalID block_index=0; block_index<populations[popID].vmesh.size(); ++block_index) {
          const vmesh::GlobalID globalID = populations[popID].vmesh.getGlobalID(block_index);
-         if (compute_block_has_content(globalID,popID)){
+         if (compute_block_has_content(block_index,popID)){
             velocity_block_with_content_list.push_back(globalID);
          } else {
             velocity_block_with_no_content_list.push_back(globalID);
@@ -1486,12 +1614,36 @@ namespace spatial_cell {
          } else {
             populations[popID].velocityBlockMinValue = newMinValue;
          }
-         return;
       } else {
          populations[popID].velocityBlockMinValue = getObjectWrapper().particleSpecies[popID].sparseMinValue;
-         return;
       }
-      return;
+      // Cells, or processes, exceeding their velocity block budget use a raised threshold
+      populations[popID].velocityBlockMinValue *= populations[popID].velocityBlockMinValueScale*P::sparseRankMinValueScale;
+   }
+
+   /** Adjust the sparsity threshold scale of the given population against the 
+    * per-cell velocity block budget. The scale is doubled if the cell holds more 
+    * blocks than the budget allows (up to a factor of 1024), and relaxed back towards one once the cell 
+    * is well under the budget. Call updateSparseMinValue afterwards.
+    * @param popID ID of the particle species.
+    * @param maxBlocks Velocity block budget of the cell, zero means unlimited.
+    * @return If true, the cell exceeded its budget and the threshold was raised.*/
+   bool SpatialCell::updateSparseMinValueScale(const int& popID,const vmesh::LocalID& maxBlocks) {
+      Population& pop = populations[popID];
+      if (maxBlocks == 0) {
+         pop.velocityBlockMinValueScale = 1.0;
+         return false;
+      }
+      const Real maxScale = 1024.0;
+      const vmesh::LocalID nBlocks = pop.vmesh.size();
+      if (nBlocks > maxBlocks) {
+         pop.velocityBlockMinValueScale = std::min(maxScale,(Real)2.0*pop.velocityBlockMinValueScale);
+         return true;
+      }
+      if (nBlocks < maxBlocks/2 && pop.velocityBlockMinValueScale > 1.0) {
+         pop.velocityBlockMinValueScale = std::max((Real)1.0,(Real)0.5*pop.velocityBlockMinValueScale);
+      }
+      return false;
    }
 
 } // namespace spatial_cell
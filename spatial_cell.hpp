@@ -150,10 +150,15 @@ namespace spatial_cell {
       vmesh::LocalID N_blocks;                                       /**< Number of velocity blocks, used when receiving velocity 
                                                                       * mesh from remote neighbors using MPI.*/
       Real velocityBlockMinValue;
+      Real velocityBlockMinValueScale;                               /**< Factor applied to the sparsity threshold, raised above one 
+                                                                      * while the cell exceeds its velocity block budget.*/
       vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID> vmesh;     /**< Velocity mesh. Contains all velocity blocks that exist 
                                                                       * in this spatial cell. Cells are identified by their unique 
                                                                       * global IDs.*/
       vmesh::VelocityBlockContainer<vmesh::LocalID> blockContainer;  /**< Velocity block data.*/
+      std::vector<Realf> blockMaxValues;                             /**< Maximum value of each velocity block, indexed by local ID. 
+                                                                      * Written by the acceleration solver.*/
+      bool blockMaxValuesValid;                                      /**< If true, blockMaxValues is up to date with block data.*/
    };
 
    class SpatialCell {
@@ -208,6 +213,7 @@ namespace spatial_cell {
       vmesh::GlobalID get_velocity_block_global_id(const vmesh::LocalID& blockLID,const int& popID) const;
       vmesh::LocalID get_velocity_block_local_id(const vmesh::GlobalID& blockGID,const int& popID) const;
       void get_velocity_block_size(const int& popID,const vmesh::GlobalID block,Real size[3]);
+      void get_velocity_block_size(const int& popID,const Real* coords,Real size[3]);
       Real get_velocity_block_vx_min(const int& popID,const vmesh::GlobalID block) const;
       Real get_velocity_block_vx_max(const int& popID,const vmesh::GlobalID block) const;
       Real get_velocity_block_vy_min(const int& popID,const vmesh::GlobalID block) const;
@@ -266,6 +272,8 @@ namespace spatial_cell {
       vmesh::VelocityBlockContainer<vmesh::LocalID>& get_velocity_blocks(const size_t& popID);
       vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& get_velocity_mesh_temporary();
       vmesh::VelocityBlockContainer<vmesh::LocalID>& get_velocity_blocks_temporary();
+      std::vector<Realf>& get_velocity_block_max_values(const int& popID);
+      void set_velocity_block_max_values_valid(const int& popID);
 
       Realf get_value(const Real vx,const Real vy,const Real vz,const int& popID) const;
       Realf get_value(const vmesh::GlobalID& blockGID, const unsigned int cell, const int& popID) const;
@@ -287,6 +295,7 @@ namespace spatial_cell {
       static void set_mpi_transfer_type(const uint64_t type,bool atSysBoundaries=false);
       void set_mpi_transfer_enabled(bool transferEnabled);
       void updateSparseMinValue(const int& popID);
+      bool updateSparseMinValueScale(const int& popID,const vmesh::LocalID& maxBlocks);
       Real getVelocityBlockMinValue(const int& popID) const;
 
       // Random number generator functions
@@ -306,6 +315,8 @@ namespace spatial_cell {
       Realf* neighbor_block_data;                                             /**< Pointers for translation operator. We can point to neighbor
                                                                                * cell block data. We do not allocate memory for the pointer.*/
       vmesh::LocalID neighbor_number_of_blocks;
+      std::vector<std::pair<vmesh::GlobalID,vmesh::LocalID> > sorted_velocity_block_list; /**< (GID,LID) pairs of the translated population sorted by GID.
+                                                                               * Only valid during spatial translation, see createSortedBlockLists().*/
       uint sysBoundaryFlag;                                                   /**< What type of system boundary does the cell belong to. 
                                                                                * Enumerated in the sysboundarytype namespace's enum.*/
       uint sysBoundaryLayer;                                                  /**< Layers counted from closest systemBoundary. If 0 then it has not 
@@ -323,7 +334,10 @@ namespace spatial_cell {
     private:
       SpatialCell& operator=(const SpatialCell&);
       
-      bool compute_block_has_content(const vmesh::GlobalID& block,const int& popID) const;
+      bool compute_block_has_content(const vmesh::LocalID& blockLID,const int& popID) const;
+      Real get_velocity_speed_ceiling(const int& popID,Real referenceV[3]) const;
+      bool velocity_block_is_beyond_speed_ceiling(const int& popID,const vmesh::GlobalID& blockGID,
+                                                  const Real referenceV[3],const Real& ceiling);
       void merge_values_recursive(const int& popID,vmesh::GlobalID parentGID,vmesh::GlobalID blockGID,uint8_t refLevel,bool recursive,const Realf* data,
 				  std::set<vmesh::GlobalID>& blockRemovalList);
 
@@ -1010,6 +1024,20 @@ namespace spatial_cell {
    inline void SpatialCell::get_velocity_block_size(const int& popID,const vmesh::GlobalID block,Real blockSize[3]) {
       populations[popID].vmesh.getBlockSize(block,blockSize);
    }
+
+   /*!
+    Returns the size of the velocity block at given location. Outside of the
+    velocity grid the average block size of the base grid level is returned.
+    */
+   inline void SpatialCell::get_velocity_block_size(const int& popID,const Real* coords,Real blockSize[3]) {
+      const vmesh::GlobalID block = get_velocity_block(popID,coords);
+      if (block == vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>::invalidGlobalID()) {
+         const Real* gridBlockSize = populations[popID].vmesh.getBlockSize(0);
+         for (int i=0; i<3; ++i) blockSize[i] = gridBlockSize[i];
+         return;
+      }
+      populations[popID].vmesh.getBlockSize(block,blockSize);
+   }
    
    /*!
     Returns the edge where given velocity block starts.
@@ -1483,6 +1511,22 @@ namespace spatial_cell {
       return blockContainerTemp;
    }
 
+   /** Get the per-block maximum values of the given population. A solver that 
+    * touches all block data last may fill these, and then call set_velocity_block_max_values_valid, 
+    * so that update_velocity_block_content_lists does not need to scan the data.
+    * @param popID ID of the particle species.
+    * @return Maximum values indexed by velocity block local ID.*/
+   inline std::vector<Realf>& SpatialCell::get_velocity_block_max_values(const int& popID) {
+      return populations[popID].blockMaxValues;
+   }
+
+   /** Mark the per-block maximum values of the given population as up to date. 
+    * They are used once, by the next call to update_velocity_block_content_lists.
+    * @param popID ID of the particle species.*/
+   inline void SpatialCell::set_velocity_block_max_values_valid(const int& popID) {
+      populations[popID].blockMaxValuesValid = true;
+   }
+
    /*!
     * Gets the value of a velocity cell at given coordinates.
     * 
@@ -1542,7 +1586,9 @@ namespace spatial_cell {
    }
 
    /*!
-    Removes all velocity blocks from this spatial cell and frees memory in the cell
+    Removes all velocity blocks of the population from this spatial cell and frees 
+    all memory reserved for them. The storage is allocated again when the next 
+    block is inserted.
     */
     inline void SpatialCell::clear(const int& popID) {
        #ifdef DEBUG_SPATIAL_CELL
@@ -1555,6 +1601,8 @@ namespace spatial_cell {
        
       populations[popID].vmesh.clear();
       populations[popID].blockContainer.clear();
+      std::vector<Realf>().swap(populations[popID].blockMaxValues);
+      populations[popID].blockMaxValuesValid = false;
     }
 
    /*!
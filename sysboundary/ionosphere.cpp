@@ -747,20 +747,23 @@ namespace SBC {
 
       const vmesh::LocalID* vblocks_ini = cell.get_velocity_grid_length(popID,refLevel);
 
+      // Search along vx, stepping by the size of the velocity block at 
+      // the search point (block sizes vary in stretched meshes)
+      Real V[3] = {0.0,0.0,0.0};
+      Real dvBlock[3];
       while (search) {
+         cell.get_velocity_block_size(popID,V,dvBlock);
          #warning TODO: add SpatialCell::getVelocityBlockMinValue() in place of sparseMinValue ? (if applicable)
          if (0.1 * getObjectWrapper().particleSpecies[popID].sparseMinValue > 
-            shiftedMaxwellianDistribution(popID,counter*cell.get_velocity_grid_block_size(popID,refLevel)[0], 0.0, 0.0)
+            shiftedMaxwellianDistribution(popID,V[0], 0.0, 0.0)
             || counter > vblocks_ini[0]) {
             search = false;
          }
          ++counter;
+         V[0] += dvBlock[0];
       }
-      counter+=2;
-      Real vRadiusSquared 
-              = (Real)counter*(Real)counter
-              * cell.get_velocity_grid_block_size(popID,refLevel)[0]
-              * cell.get_velocity_grid_block_size(popID,refLevel)[0];
+      V[0] += 2*dvBlock[0];
+      Real vRadiusSquared = V[0]*V[0];
 
       for (uint kv=0; kv<vblocks_ini[2]; ++kv) 
          for (uint jv=0; jv<vblocks_ini[1]; ++jv)
@@ -139,14 +139,19 @@ namespace SBC {
       
       const vmesh::LocalID* vblocks_ini = cell.get_velocity_grid_length(popID,refLevel);
 
+      // Search along vx from the bulk velocity, stepping by the size of the 
+      // velocity block at the search point (block sizes vary in stretched meshes)
+      Real V[3] = {VX0,VY0,VZ0};
+      Real dvBlock[3];
       while (search) {
+         cell.get_velocity_block_size(popID,V,dvBlock);
          #warning TODO: add SpatialCell::getVelocityBlockMinValue() in place of sparseMinValue?
          if (0.1 * getObjectWrapper().particleSpecies[popID].sparseMinValue > 
              maxwellianDistribution(
                                     popID,
                                     rho,
                                     T,
-                                    counter*cell.get_velocity_grid_block_size(popID,refLevel)[0], 0.0, 0.0
+                                    V[0]-VX0, 0.0, 0.0
                                    )
              ||
              counter > vblocks_ini[0]
@@ -154,13 +159,11 @@ namespace SBC {
             search = false;
          }
          counter++;
+         V[0] += dvBlock[0];
       }
-      counter+=2;
+      V[0] += 2*dvBlock[0];
 
-      Real vRadiusSquared 
-              = (Real)counter*(Real)counter
-              * cell.get_velocity_grid_block_size(popID,refLevel)[0]
-              * cell.get_velocity_grid_block_size(popID,refLevel)[0];
+      Real vRadiusSquared = (V[0]-VX0)*(V[0]-VX0);
       
       for (uint kv=0; kv<vblocks_ini[2]; ++kv) 
          for (uint jv=0; jv<vblocks_ini[1]; ++jv)
@@ -424,9 +424,9 @@ namespace SBC {
       //just copy data to existing blocks, no modification of to blocks allowed
       for (vmesh::LocalID blockLID=0; blockLID<to->get_number_of_velocity_blocks(popID); ++blockLID) {
          const vmesh::GlobalID blockGID = to->get_velocity_block_global_id(blockLID,popID);
-//          const Realf* fromBlock_data = from->get_data(from->get_velocity_block_local_id(blockGID) );
+         const vmesh::LocalID fromBlockLID = from->get_velocity_block_local_id(blockGID,popID);
          Realf* toBlock_data = to->get_data(blockLID,popID);
-         if (from->get_velocity_block_local_id(blockGID,popID) == from->invalid_local_id()) {
+         if (fromBlockLID == from->invalid_local_id()) {
             for (unsigned int i = 0; i < VELOCITY_BLOCK_LENGTH; i++) {
                toBlock_data[i] = 0.0; //block did not exist in from cell, fill with zeros.
             }
@@ -440,6 +440,7 @@ namespace SBC {
             creal dvyCell = blockParameters[BlockParams::DVY];
             creal dvzCell = blockParameters[BlockParams::DVZ];
             
+            const Realf* fromBlock_data = from->get_data(fromBlockLID,popID);
             std::array<Realf*,27> flowtoCellsBlockCache = getFlowtoCellsBlock(flowtoCells, blockGID, popID);
             
             for (uint kc=0; kc<WID; ++kc) {
@@ -454,7 +455,7 @@ namespace SBC {
                      const int vxCellSign = vxCellCenter < 0 ? -1 : 1;
                      const int vyCellSign = vyCellCenter < 0 ? -1 : 1;
                      const int vzCellSign = vzCellCenter < 0 ? -1 : 1;
-                     Realf value = from->get_value(blockGID, cell, popID);
+                     Realf value = fromBlock_data[cell];
                      //loop over spatial cells in quadrant of influence
                      for(int dvx = 0 ; dvx <= 1; dvx++) {
                         for(int dvy = 0 ; dvy <= 1; dvy++) {
@@ -466,7 +467,7 @@ namespace SBC {
                            }
                         }
                      }
-                     to->set_value(blockGID, cell,  value, popID);
+                     toBlock_data[cell] = value;
                   }
                }
             }
@@ -504,6 +505,7 @@ namespace SBC {
          to->parameters[CellParams::P_11] = from->parameters[CellParams::P_11];
          to->parameters[CellParams::P_22] = from->parameters[CellParams::P_22];
          to->parameters[CellParams::P_33] = from->parameters[CellParams::P_33];
+         to->parameters[CellParams::RHOQ] = from->parameters[CellParams::RHOQ];
       }
       if(to->sysBoundaryLayer == 1 && !copyMomentsOnly) { // Do this only for the first layer, the other layers do not need this. Do only if copyMomentsOnly is false.
 
@@ -552,7 +554,7 @@ namespace SBC {
          for (vmesh::LocalID block_i=0; block_i<to->get_number_of_velocity_blocks(popID); ++block_i) {
             const vmesh::GlobalID blockGID = to->get_velocity_block_global_id(block_i,popID);
             const vmesh::LocalID fromBlockLID = from->get_velocity_block_local_id(blockGID,popID);
-            if (from->get_velocity_block_local_id(blockGID,popID) == from->invalid_local_id()) {
+            if (fromBlockLID == from->invalid_local_id()) {
                for (unsigned int i = 0; i < VELOCITY_BLOCK_LENGTH; i++) {
                   toBlock_data[block_i*SIZE_VELBLOCK+i] = 0.0; //block did not exist in from cell, fill with zeros.
                }
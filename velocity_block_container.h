@@ -58,6 +58,7 @@ namespace vmesh {
       LID push_back();
       LID push_back(const uint32_t& N_blocks);
       bool recapacitate(const LID& capacity);
+      void resetSize(const LID& newSize);
       bool setSize(const LID& newSize);
       LID size() const;
       size_t sizeInBytes() const;
@@ -293,6 +294,28 @@ namespace vmesh {
       }
    }
 
+   /** Set the number of blocks without preserving the contents of existing blocks.
+    * The current allocation is reused unless it is too small, or so much larger 
+    * than needed that holding on to it would waste memory. Block data and 
+    * parameters are left uninitialized. Setting the size to zero releases all memory.
+    * @param newSize New number of blocks.*/
+   template<typename LID> inline
+   void VelocityBlockContainer<LID>::resetSize(const LID& newSize) {
+      if (newSize == 0) {
+         clear();
+         return;
+      }
+      const LID maxCapacity = 2 + newSize * BLOCK_ALLOCATION_FACTOR * BLOCK_ALLOCATION_FACTOR;
+      if (newSize >= currentCapacity || currentCapacity > maxCapacity) {
+         currentCapacity = 2 + newSize * BLOCK_ALLOCATION_FACTOR;
+         std::vector<Realf,aligned_allocator<Realf,WID3> > dummy_data(currentCapacity*WID3);
+         std::vector<Real,aligned_allocator<Real,BlockParams::N_VELOCITY_BLOCK_PARAMS> > dummy_parameters(currentCapacity*BlockParams::N_VELOCITY_BLOCK_PARAMS);
+         block_data.swap(dummy_data);
+         parameters.swap(dummy_parameters);
+      }
+      numberOfBlocks = newSize;
+   }
+
    template<typename LID> inline
    bool VelocityBlockContainer<LID>::setSize(const LID& newSize) {
       numberOfBlocks = newSize;
@@ -55,6 +55,7 @@ namespace vmesh {
       GID findBlockDown(uint8_t& refLevel,GID cellIndices[3]) const;
       GID findBlock(uint8_t& refLevel,GID cellIndices[3]) const;
       bool getBlockCoordinates(const GID& globalID,Real coords[3]) const;
+      const std::vector<Real>& getBlockEdges(const int& crd) const;
       void getBlockInfo(const GID& globalID,Real* array) const;
       const Real* getBlockSize(const uint8_t& refLevel) const;
       bool getBlockSize(const GID& globalID,Real size[3]) const;
@@ -375,6 +376,15 @@ namespace vmesh {
       return true;
    }
 
+   /** Get the block edge coordinates of a stretched coordinate direction. 
+    * The AMR mesh does not support stretching, so the edges are always empty.
+    * @param crd Coordinate direction.
+    * @return Empty vector.*/
+   template<typename GID,typename LID> inline
+   const std::vector<Real>& VelocityMesh<GID,LID>::getBlockEdges(const int& crd) const {
+      return meshParameters[meshID].blockEdges[crd];
+   }
+
    template<typename GID,typename LID> inline
    void VelocityMesh<GID,LID>::getBlockInfo(const GID& globalID,Real* array) const {
       #ifdef DEBUG_AMR_MESH
@@ -23,6 +23,7 @@
 #ifndef VELOCITY_MESH_OLD_H
 #define VELOCITY_MESH_OLD_H
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <stdint.h>
@@ -50,6 +51,7 @@ namespace vmesh {
       GID findBlockDown(uint8_t& refLevel,GID cellIndices[3]) const;
       GID findBlock(uint8_t& refLevel,GID cellIndices[3]) const;
       bool getBlockCoordinates(const GID& globalID,Real coords[3]) const;
+      const std::vector<Real>& getBlockEdges(const int& crd) const;
       void getBlockInfo(const GID& globalID,Real* array) const;
       const Real* getBlockSize(const uint8_t& refLevel) const;
       bool getBlockSize(const GID& globalID,Real size[3]) const;
@@ -105,6 +107,9 @@ namespace vmesh {
       static std::vector<vmesh::MeshParameters> meshParameters;
       size_t meshID;
 
+      Real getBlockEdge(const int& crd,const LID& index) const;
+      LID getBlockIndex(const int& crd,const Real& coord) const;
+
       std::vector<GID> localToGlobalMap;
       std::unordered_map<GID,LID> globalToLocalMap;
    };
@@ -236,11 +241,46 @@ namespace vmesh {
          return false;
       }
 
-      coords[0] = meshParameters[meshID].meshMinLimits[0] + indices[0]*meshParameters[meshID].blockSize[0];
-      coords[1] = meshParameters[meshID].meshMinLimits[1] + indices[1]*meshParameters[meshID].blockSize[1];
-      coords[2] = meshParameters[meshID].meshMinLimits[2] + indices[2]*meshParameters[meshID].blockSize[2];
+      coords[0] = getBlockEdge(0,indices[0]);
+      coords[1] = getBlockEdge(1,indices[1]);
+      coords[2] = getBlockEdge(2,indices[2]);
       return true;
    }
+
+   /** Get the block edge coordinates of a stretched coordinate direction.
+    * @param crd Coordinate direction.
+    * @return Edge coordinates of all blocks (gridLength+1 values), empty if 
+    * the blocks are uniform in the given direction.*/
+   template<typename GID,typename LID> inline
+   const std::vector<Real>& VelocityMesh<GID,LID>::getBlockEdges(const int& crd) const {
+      return meshParameters[meshID].blockEdges[crd];
+   }
+
+   /** Get the lower edge coordinate of a block.
+    * @param crd Coordinate direction.
+    * @param index Block index in the given direction, gridLength[crd] gives the upper edge of the mesh.
+    * @return Edge coordinate.*/
+   template<typename GID,typename LID> inline
+   Real VelocityMesh<GID,LID>::getBlockEdge(const int& crd,const LID& index) const {
+      const vmesh::MeshParameters& params = meshParameters[meshID];
+      if (params.blockEdges[crd].size() == 0) return params.meshMinLimits[crd] + index*params.blockSize[crd];
+      return params.blockEdges[crd][index];
+   }
+
+   /** Get the index of the block containing the given coordinate. The 
+    * coordinate must be inside the mesh bounding box.
+    * @param crd Coordinate direction.
+    * @param coord Coordinate value.
+    * @return Block index in the given direction.*/
+   template<typename GID,typename LID> inline
+   LID VelocityMesh<GID,LID>::getBlockIndex(const int& crd,const Real& coord) const {
+      const vmesh::MeshParameters& params = meshParameters[meshID];
+      if (params.blockEdges[crd].size() == 0) {
+         return static_cast<LID>(floor((coord - params.meshMinLimits[crd]) / params.blockSize[crd]));
+      }
+      const std::vector<Real>& edges = params.blockEdges[crd];
+      return std::upper_bound(edges.begin(),edges.end(),coord) - edges.begin() - 1;
+   }
    
    template<typename GID,typename LID> inline
    void VelocityMesh<GID,LID>::getBlockInfo(const GID& globalID,Real* array) const {
@@ -257,15 +297,21 @@ namespace vmesh {
 
       // Indices 0-2 contain coordinates of the lower left corner.
       // The values are the same as if getBlockCoordinates(globalID,&(array[0])) was called
-      array[0] = meshParameters[meshID].meshMinLimits[0] + indices[0]*meshParameters[meshID].blockSize[0];
-      array[1] = meshParameters[meshID].meshMinLimits[1] + indices[1]*meshParameters[meshID].blockSize[1];
-      array[2] = meshParameters[meshID].meshMinLimits[2] + indices[2]*meshParameters[meshID].blockSize[2];
+      array[0] = getBlockEdge(0,indices[0]);
+      array[1] = getBlockEdge(1,indices[1]);
+      array[2] = getBlockEdge(2,indices[2]);
 
       // Indices 3-5 contain the cell size.
       // The values are the same as if getCellSize(globalID,&(array[3])) was called
-      array[3] = meshParameters[meshID].cellSize[0];
-      array[4] = meshParameters[meshID].cellSize[1];
-      array[5] = meshParameters[meshID].cellSize[2];
+      if (meshParameters[meshID].stretched == false) {
+         array[3] = meshParameters[meshID].cellSize[0];
+         array[4] = meshParameters[meshID].cellSize[1];
+         array[5] = meshParameters[meshID].cellSize[2];
+      } else {
+         for (int crd=0; crd<3; ++crd) {
+            array[3+crd] = (getBlockEdge(crd,indices[crd]+1) - array[crd]) / meshParameters[meshID].blockLength[crd];
+         }
+      }
    }
 
    template<typename GID,typename LID> inline
@@ -275,9 +321,20 @@ namespace vmesh {
    
    template<typename GID,typename LID> inline
    bool VelocityMesh<GID,LID>::getBlockSize(const GID& globalID,Real size[3]) const {
-      size[0] = meshParameters[meshID].blockSize[0];
-      size[1] = meshParameters[meshID].blockSize[1];
-      size[2] = meshParameters[meshID].blockSize[2];
+      if (meshParameters[meshID].stretched == false) {
+         size[0] = meshParameters[meshID].blockSize[0];
+         size[1] = meshParameters[meshID].blockSize[1];
+         size[2] = meshParameters[meshID].blockSize[2];
+         return true;
+      }
+
+      uint8_t refLevel;
+      LID indices[3];
+      getIndices(globalID,refLevel,indices[0],indices[1],indices[2]);
+      if (indices[0] == invalidBlockIndex()) return false;
+      for (int crd=0; crd<3; ++crd) {
+         size[crd] = getBlockEdge(crd,indices[crd]+1) - getBlockEdge(crd,indices[crd]);
+      }
       return true;
    }
    
@@ -288,9 +345,15 @@ namespace vmesh {
 
    template<typename GID,typename LID> inline
    bool VelocityMesh<GID,LID>::getCellSize(const GID& globalID,Real size[3]) const {
-      size[0] = meshParameters[meshID].cellSize[0];
-      size[1] = meshParameters[meshID].cellSize[1];
-      size[2] = meshParameters[meshID].cellSize[2];
+      if (meshParameters[meshID].stretched == false) {
+         size[0] = meshParameters[meshID].cellSize[0];
+         size[1] = meshParameters[meshID].cellSize[1];
+         size[2] = meshParameters[meshID].cellSize[2];
+         return true;
+      }
+
+      if (getBlockSize(globalID,size) == false) return false;
+      for (int crd=0; crd<3; ++crd) size[crd] /= meshParameters[meshID].blockLength[crd];
       return true;
    }
    
@@ -320,9 +383,9 @@ namespace vmesh {
       }
 
       const LID indices[3] = {
-         static_cast<LID>(floor((coords[0] - meshParameters[meshID].meshMinLimits[0]) / meshParameters[meshID].blockSize[0])),
-         static_cast<LID>(floor((coords[1] - meshParameters[meshID].meshMinLimits[1]) / meshParameters[meshID].blockSize[1])),
-         static_cast<LID>(floor((coords[2] - meshParameters[meshID].meshMinLimits[2]) / meshParameters[meshID].blockSize[2]))
+         getBlockIndex(0,coords[0]),
+         getBlockIndex(1,coords[1]),
+         getBlockIndex(2,coords[2])
       };
 
       return indices[2]*meshParameters[meshID].gridLength[1]*meshParameters[meshID].gridLength[0] 
@@ -545,6 +608,31 @@ namespace vmesh {
       meshParameters[meshID].cellSize[1] = meshParameters[meshID].blockSize[1] / meshParameters[meshID].blockLength[1];
       meshParameters[meshID].cellSize[2] = meshParameters[meshID].blockSize[2] / meshParameters[meshID].blockLength[2];
 
+      // Block edges of stretched coordinates. Block widths grow geometrically 
+      // away from the centre of the mesh and are scaled to fill the bounding box.
+      meshParameters[meshID].stretched = false;
+      for (int crd=0; crd<3; ++crd) {
+         std::vector<Real>& edges = meshParameters[meshID].blockEdges[crd];
+         edges.clear();
+         if (meshParameters[meshID].stretchFactor[crd] == 1.0) continue;
+         meshParameters[meshID].stretched = true;
+
+         const LID N = meshParameters[meshID].gridLength[crd];
+         std::vector<Real> widths(N);
+         Real sum = 0.0;
+         for (LID i=0; i<N; ++i) {
+            const Real distance = floor(fabs(i + 0.5 - 0.5*N));
+            widths[i] = pow(meshParameters[meshID].stretchFactor[crd],distance);
+            sum += widths[i];
+         }
+         edges.resize(N+1);
+         edges[0] = meshParameters[meshID].meshMinLimits[crd];
+         for (LID i=0; i<N; ++i) {
+            edges[i+1] = edges[i] + widths[i]*meshParameters[meshID].gridSize[crd]/sum;
+         }
+         edges[N] = meshParameters[meshID].meshMaxLimits[crd];
+      }
+
       meshParameters[meshID].max_velocity_blocks 
               = meshParameters[meshID].gridLength[0]
               * meshParameters[meshID].gridLength[1]
@@ -50,6 +50,8 @@ namespace vmesh {
       vmesh::LocalID gridLength[3];             /**< Number of blocks in mesh per coordinate at base grid level.*/
       vmesh::LocalID blockLength[3];            /**< Number of phase-space cells per coordinate in block.*/
       uint8_t refLevelMaxAllowed;               /**< Maximum refinement level allowed, 0=no refinement.*/
+      Real stretchFactor[3];                    /**< Width ratio of adjacent blocks, per coordinate. Blocks get wider 
+                                                 * by this factor per block away from the mesh centre, 1=uniform mesh.*/
       
       // ***** DERIVED PARAMETERS, CALCULATED BY VELOCITY MESH ***** //
       bool initialized;                         /**< If true, variables in this struct contain sensible values.*/
@@ -58,6 +60,10 @@ namespace vmesh {
       Real blockSize[3];                        /**< Size of a block at base grid level.*/
       Real cellSize[3];                         /**< Size of a cell in a block at base grid level.*/
       Real gridSize[3];                         /**< Physical size of the grid bounding box.*/
+      bool stretched;                           /**< If true, block sizes are not uniform in at least one coordinate 
+                                                 * and blockSize and cellSize only contain average values.*/
+      std::vector<Real> blockEdges[3];          /**< Block edge coordinates (gridLength+1 values) of stretched 
+                                                 * coordinates, empty for uniform coordinates.*/
 
       // ***** DERIVED PARAMETERS SPECIFIC TO AMR ***** //
       std::vector<vmesh::GlobalID> offsets;     /**< Block global ID offsets for each refinement level.*/
@@ -73,6 +79,8 @@ namespace vmesh {
 
       MeshParameters() {
          initialized = false;
+         stretched = false;
+         for (int i=0; i<3; ++i) stretchFactor[i] = 1.0;
       }
    };
 
@@ -48,6 +48,7 @@
 #include "grid.h"
 #include "iowrite.h"
 #include "ioread.h"
+#include "mpi_progress.h"
 
 #include "object_wrapper.h"
 
@@ -482,6 +483,8 @@ int main(int argn,char* args[]) {
    double beforeTime = MPI_Wtime();
    double beforeSimulationTime=P::t_min;
    double beforeStep=P::tstep_min;
+   bool budgetRebalanced = false; // Has load been balanced due to sparse.maxBlocksPerRank
+   uint lastBudgetRebalance = 0;  // Timestep of the last such load balance
    
    while(P::tstep <= P::tstep_max  &&
          P::t-P::dt <= P::t_max+DT_EPSILON &&
@@ -612,9 +615,32 @@ int main(int argn,char* args[]) {
          break;
       }
       
+      // Check the per-process velocity block budget. Load balancing cannot 
+      // reduce the total number of blocks, so budget-triggered load balances 
+      // are spaced out and processes still over budget raise their thresholds.
+      int doBudgetRebalance = 0;
+      if (P::sparseMaxBlocksPerRank > 0) {
+         const bool recentlyRebalanced = budgetRebalanced && 
+            P::tstep < lastBudgetRebalance + P::sparseRankBudgetRebalanceInterval;
+         if (checkRankBlockBudget(mpiGrid,recentlyRebalanced) == true && recentlyRebalanced == false) {
+            doBudgetRebalance = 1;
+            budgetRebalanced = true;
+            lastBudgetRebalance = P::tstep;
+         }
+      }
+      
       //Re-loadbalance if needed
       //TODO - add LB measure and do LB if it exceeds threshold
-      if(P::tstep % P::rebalanceInterval == 0 && P::tstep > P::tstep_min) {
+      if((P::tstep % P::rebalanceInterval == 0 || doBudgetRebalance > 0) && P::tstep > P::tstep_min) {
+         if (doBudgetRebalance > 0) {
+            logFile << "(LB): A process is close to the velocity block budget of " << P::sparseMaxBlocksPerRank << " blocks" << endl << writeVerbose;
+            // The acceleration timings in the weight counters are only measured
+            // before a scheduled load balance, so balance on block counts instead
+            const vector<CellID>& cells = getLocalCells();
+            for (size_t i=0; i<cells.size(); ++i) {
+               mpiGrid[cells[i]]->parameters[CellParams::LBWEIGHTCOUNTER] = mpiGrid[cells[i]]->get_number_of_all_velocity_blocks();
+            }
+         }
          logFile << "(LB): Start load balance, tstep = " << P::tstep << " t = " << P::t << endl << writeVerbose;
          balanceLoad(mpiGrid, sysBoundaries);
          addTimedBarrier("barrier-end-load-balance");
@@ -799,6 +825,7 @@ int main(int argn,char* args[]) {
    phiprof::stop("main");
    
    phiprof::print(MPI_COMM_WORLD,"phiprof");
+   mpiprogress::report();
    
    if (myRank == MASTER_RANK) logFile << "(MAIN): Exiting." << endl << writeVerbose;
    logFile.close();
@@ -33,31 +33,50 @@
 using namespace std;
 
 /*
-  Compute parabolic reconstruction with an explicit scheme
+  Compute parabolic reconstruction from unfiltered face value estimates
+  fv_l and fv_r of cell k. These are filtered here, so the unfiltered right
+  face of cell k can be passed on as the left face of cell k + 1.
 */
-inline void compute_ppm_coeff(const Vec * const values, face_estimate_order order, uint k, Vec a[3]){
-   Vec fv_l; /*left face value*/
-   Vec fv_r; /*right face value*/
-   compute_filtered_face_values(values, k, order, fv_l, fv_r); 
-   
+inline void compute_ppm_coeff_from_faces(const Vec * const values, uint k, Vec fv_l, Vec fv_r, Vec a[3]){
+   filter_face_values(values, k, fv_l, fv_r);
+
    //Coella et al, check for monotonicity   
-   Vec m_face = fv_l;
-   Vec p_face = fv_r;
-   m_face = select((p_face - m_face) * (values[k] - 0.5 * (m_face + p_face)) >
-                   (p_face - m_face)*(p_face - m_face) * one_sixth,
-                   3 * values[k] - 2 * p_face,
-                   m_face);
-  p_face = select(-(p_face - m_face) * (p_face - m_face) * one_sixth >
-                   (p_face - m_face) * (values[k] - 0.5 * (m_face + p_face)),
-                  3 * values[k] - 2 * m_face,
-                  p_face);
-   
+   const Vec m_face = fv_l;
+   const Vec p_face = fv_r;
+   const Vec face_diff = p_face - m_face;
+   const Vec face_diff_sq_sixth = face_diff * face_diff * one_sixth;
+   const Vec curvature = face_diff * (values[k] - 0.5 * (m_face + p_face));
+   const Vec m_face_mono = select(curvature > face_diff_sq_sixth,
+                                  3 * values[k] - 2 * p_face,
+                                  m_face);
+   // p_face test uses the already limited m_face, as in the original scheme
+   const Vec face_diff_mono = p_face - m_face_mono;
+   const Vec p_face_mono = select(-face_diff_mono * face_diff_mono * one_sixth >
+                                  face_diff_mono * (values[k] - 0.5 * (m_face_mono + p_face)),
+                                  3 * values[k] - 2 * m_face_mono,
+                                  p_face);
+
    //Fit a second order polynomial for reconstruction see, e.g., White
    //2008 (PQM article) (note additional integration factors built in,
    //contrary to White (2008) eq. 4
-   a[0] = m_face;
-   a[1] = 3.0 * values[k] - 2.0 * m_face - p_face;
-   a[2] = (m_face + p_face - 2.0 * values[k]);
+   a[0] = m_face_mono;
+   a[1] = 3.0 * values[k] - 2.0 * m_face_mono - p_face_mono;
+   a[2] = (m_face_mono + p_face_mono - 2.0 * values[k]);
+}
+
+/*
+  Compute parabolic reconstruction with an explicit scheme
+*/
+inline void compute_ppm_coeff(const Vec * const values, face_estimate_order order, uint k, Vec a[3]){
+   Vec fv_l; /*left face value*/
+   Vec fv_r; /*right face value*/
+   if(order == h5) {
+      compute_h5_face_values(values, k, fv_l, fv_r);
+   } else {
+      compute_left_face_value(values, k, order, fv_l);
+      compute_left_face_value(values, k + 1, order, fv_r);
+   }
+   compute_ppm_coeff_from_faces(values, k, fv_l, fv_r, a);
 }
 
 #endif
@@ -142,13 +142,13 @@ inline void filter_pqm_monotonicity(Vec *values, uint k, Vec &fv_l, Vec &fv_r, V
 //   White, Laurent, and Alistair Adcroft. “A High-Order Finite Volume Remapping Scheme for Nonuniform Grids: The Piecewise Quartic Method (PQM).” Journal of Computational Physics 227, no. 15 (July 2008): 7394–7422. doi:10.1016/j.jcp.2008.04.026.
 // */
 
-inline void compute_pqm_coeff(Vec *values, face_estimate_order order, uint k, Vec a[5]){
-   Vec fv_l; /*left face value*/
-   Vec fv_r; /*right face value*/
-   Vec fd_l; /*left face derivative*/
-   Vec fd_r; /*right face derivative*/
-   
-   compute_filtered_face_values_derivatives(values, k, order, fv_l, fv_r, fd_l, fd_r); 
+/*
+  Compute PQM reconstruction from unfiltered face value and derivative
+  estimates of cell k. These are filtered here, so the unfiltered right face
+  estimates of cell k can be passed on as the left face of cell k + 1.
+*/
+inline void compute_pqm_coeff_from_faces(Vec *values, uint k, Vec fv_l, Vec fv_r, Vec fd_l, Vec fd_r, Vec a[5]){
+   filter_face_values_derivatives(values, k, fv_l, fv_r, fd_l, fd_r);
    filter_pqm_monotonicity(values, k, fv_l, fv_r, fd_l, fd_r); 
    
    //Fit a second order polynomial for reconstruction see, e.g., White
@@ -161,4 +161,20 @@ inline void compute_pqm_coeff(Vec *values, face_estimate_order order, uint k, Ve
    a[4] =   6.0 * values[k] +  0.5 * (fd_r - fd_l) - 3.0 * (fv_l + fv_r);
 }
 
+inline void compute_pqm_coeff(Vec *values, face_estimate_order order, uint k, Vec a[5]){
+   Vec fv_l; /*left face value*/
+   Vec fv_r; /*right face value*/
+   Vec fd_l; /*left face derivative*/
+   Vec fd_r; /*right face derivative*/
+   if(order == h5) {
+      compute_h5_face_values(values, k, fv_l, fv_r);
+   } else {
+      compute_left_face_value(values, k, order, fv_l);
+      compute_left_face_value(values, k + 1, order, fv_r);
+   }
+   compute_left_face_derivative(values, k, order, fd_l);
+   compute_left_face_derivative(values, k + 1, order, fd_r);
+   compute_pqm_coeff_from_faces(values, k, fv_l, fv_r, fd_l, fd_r, a);
+}
+
 #endif
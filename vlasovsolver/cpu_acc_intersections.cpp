@@ -54,7 +54,7 @@ Eigen::Matrix<Real,3,1> line_plane_intersection(const Eigen::Matrix<Real,3,1>& l
 }
 
 /*!
-Computes the first intersection data; this is z~ in section 2.4 in Zerroukat et al (2012). We assume all velocity cells have the same dimensions. 
+Computes the first intersection data; this is z~ in section 2.4 in Zerroukat et al (2012). Indices are in units of the average cell size, in stretched meshes cell indices are not integers (see computeCellEdges in cpu_acc_map.cpp).
 Intersection z coordinate for (i,j,k) is: intersection + i * intersection_di + j * intersection_dj + k * intersection_dk 
 \param spatial_cell spatial cell that is accelerated
 \param fwd_transform Transform that describes acceleration forward in time
@@ -167,7 +167,7 @@ void compute_intersections_1st(
 }
 
 /*!
-  Computes the second intersection data; this is x~ in section 2.4 in Zerroukat et al (2012). We assume all velocity cells have the same dimensions.
+  Computes the second intersection data; this is x~ in section 2.4 in Zerroukat et al (2012). Indices are in units of the average cell size, in stretched meshes cell indices are not integers (see computeCellEdges in cpu_acc_map.cpp).
   Intersection x coordinate for (i,j,k) is: intersection + i * intersection_di + j * intersection_dj + k * intersection_dk 
   \param spatial_cell spatial cell that is accelerated
   \param fwd_transform Transform that describes acceleration forward in time
@@ -293,7 +293,7 @@ void compute_intersections_2nd(
 }
 
 /*!
-  Computes the third intersection data; this is y intersections in Zerroukat et al (2012). We assume all velocity cells have the same dimensions.
+  Computes the third intersection data; this is y intersections in Zerroukat et al (2012). Indices are in units of the average cell size, in stretched meshes cell indices are not integers (see computeCellEdges in cpu_acc_map.cpp).
   Intersection y-coordinate for (i,j,k) is: intersection + i * intersection_di + j * intersection_dj + k * intersection_dk 
   \param spatial_cell spatial cell that is accelerated
   \param fwd_transform Transform that describes acceleration forward in time
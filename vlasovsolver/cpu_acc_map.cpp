@@ -79,10 +79,6 @@ vmesh::LocalID addVelocityBlock(const vmesh::GlobalID& blockGID,
     return newBlockLID;
 }
 
-void loadColumnBlockData(SpatialCell* spatial_cell,vmesh::GlobalID* blocks,
-                         vmesh::LocalID n_blocks,Vec* __restrict__ values,
-                         const unsigned char * const cellid_transpose);
-
 /*!
   Copies the data of a column into the values array, and zeroes the data.
   
@@ -96,18 +92,20 @@ void loadColumnBlockData(SpatialCell* spatial_cell,vmesh::GlobalID* blocks,
   j -> k
   k -> j
 
- * @param blocks Array containing block global IDs.
+ * @param blockContainer Block container of the velocity mesh.
+ * @param blocks Array containing block local IDs.
  * @param n_blocks Number of blocks in array blocks.
+ * @return Maximum absolute value of the distribution function in the column.
 */
-inline void loadColumnBlockData(//SpatialCell* spatial_cell,
-        const vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
+inline Realf loadColumnBlockData(
         vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer,
-        vmesh::GlobalID* blocks,
+        vmesh::LocalID* blocks,
         vmesh::LocalID n_blocks,
         Vec* __restrict__ values,
         const unsigned char * const cellid_transpose) {
 
    Realv blockValues[WID3];   
+   Realf columnMaxValue = 0.0;
    // first set the 0 values for the two empty blocks 
    // we store above and below the existing blocks
 
@@ -120,13 +118,14 @@ inline void loadColumnBlockData(//SpatialCell* spatial_cell,
 
    // copy block data for all blocks
    for (vmesh::LocalID block_k=0; block_k<n_blocks; ++block_k) {
-      Realf* __restrict__ data = blockContainer.getData(vmesh.getLocalID(blocks[block_k]));
+      Realf* __restrict__ data = blockContainer.getData(blocks[block_k]);
 
       //  Copy volume averages of this block, taking into account the dimension shifting
       for (uint i=0; i<WID3; ++i) {
          blockValues[i] = data[cellid_transpose[i]];
       }
       for (uint i=0; i<WID3; ++i) {
+         columnMaxValue = max(columnMaxValue,fabs(data[i]));
          data[i]=0;
       }
 
@@ -140,6 +139,85 @@ inline void loadColumnBlockData(//SpatialCell* spatial_cell,
          }
       }
    }
+   return columnMaxValue;
+}
+
+/** Computes the velocity cell edges of a stretched velocity mesh coordinate in 
+ * units of the average cell size, counted from the lower mesh limit. These are 
+ * the index units of the acceleration intersections, in a uniform coordinate 
+ * edge c is at c. Cells are uniform inside each block.
+ * @param vmesh Velocity mesh.
+ * @param crd Coordinate direction.
+ * @param cellEdges Cell edges (number of cells + 1 values), left empty if the 
+ * coordinate is uniform.*/
+void computeCellEdges(const vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
+                      const uint crd,std::vector<Realv>& cellEdges) {
+   cellEdges.clear();
+   const std::vector<Real>& blockEdges = vmesh.getBlockEdges(crd);
+   if (blockEdges.size() == 0) return;
+
+   const uint8_t REFLEVEL = 0;
+   const Real v_min = vmesh.getMeshMinLimits()[crd];
+   const Real i_dv = 1.0 / vmesh.getCellSize(REFLEVEL)[crd];
+   const uint nBlocks = blockEdges.size() - 1;
+   cellEdges.resize(nBlocks * WID + 1);
+   for (uint b=0; b<nBlocks; ++b) {
+      const Real cellSize = (blockEdges[b+1] - blockEdges[b]) / WID;
+      for (uint c=0; c<WID; ++c) {
+         cellEdges[b * WID + c] = (blockEdges[b] + c * cellSize - v_min) * i_dv;
+      }
+   }
+   cellEdges[nBlocks * WID] = (blockEdges[nBlocks] - v_min) * i_dv;
+}
+
+/** Returns the edge of a cell from a table computed by computeCellEdges. 
+ * Outside the mesh the cells have unit width.*/
+inline Realv cellEdge(const std::vector<Realv>& cellEdges,const int& cell) {
+   const int nCells = cellEdges.size() - 1;
+   if (cell < 0) return cell;
+   if (cell > nCells) return cellEdges[nCells] + (cell - nCells);
+   return cellEdges[cell];
+}
+
+/** Returns the index of the cell containing the given coordinate, in units of 
+ * computeCellEdges. Outside the mesh the cells have unit width and the index 
+ * is truncated towards zero, as truncate_to_int does for uniform meshes.*/
+inline int cellIndex(const std::vector<Realv>& cellEdges,const Realv& crd) {
+   const int nCells = cellEdges.size() - 1;
+   if (crd < cellEdges[0]) return static_cast<int>(crd);
+   if (crd >= cellEdges[nCells]) return nCells + static_cast<int>(crd - cellEdges[nCells]);
+   return upper_bound(cellEdges.begin(),cellEdges.end(),crd) - cellEdges.begin() - 1;
+}
+
+/** Vector versions of cellEdge and cellIndex, one vector element at a time.*/
+inline Vec cellEdge(const std::vector<Realv>& cellEdges,const Veci& cells) {
+   Realv edges[VECL];
+   for (int i=0; i<VECL; ++i) edges[i] = cellEdge(cellEdges,cells[i]);
+   Vec result;
+   result.load(edges);
+   return result;
+}
+
+inline Veci cellIndex(const std::vector<Realv>& cellEdges,const Vec& crds) {
+   Realv indices[VECL];
+   for (int i=0; i<VECL; ++i) indices[i] = cellIndex(cellEdges,crds[i]);
+   Vec result;
+   result.load(indices);
+   return truncate_to_int(result);
+}
+
+/** Returns the centre coordinates of cells offset+indices in units of 
+ * computeCellEdges, i.e., the non-integer cell indices used with the 
+ * intersections of a stretched coordinate.*/
+inline Vec cellCentres(const std::vector<Realv>& cellEdges,const int& offset,const Veci& indices) {
+   Realv centres[VECL];
+   for (int i=0; i<VECL; ++i) {
+      const int cell = offset + indices[i];
+      centres[i] = 0.5 * (cellEdges[cell] + cellEdges[cell + 1]) - 0.5;
+   }
+   Vec result;
+   result.load(centres);
+   return result;
 }
 
 /* 
@@ -151,17 +229,37 @@ inline void loadColumnBlockData(//SpatialCell* spatial_cell,
    pre-creates new blocks in a separate loop first (serial operation),
    then the openmp parallization would scale well (better than over
    spatial cells), and would not need synchronization.
+
+   Columns that only contain zeros (typically padding blocks added 
+   around content by adjust_velocity_blocks) are not mapped at all. 
+   Columns whose values are all below columnSkipThreshold are mapped 
+   with a piecewise constant reconstruction, which conserves mass but 
+   skips the expensive face value estimates of the higher order schemes.
+
+   If blockMaxValues is not NULL, it is filled with the maximum value 
+   of each velocity block after the mapping, indexed by local ID. All 
+   target blocks of a column set are final once the set has been mapped, 
+   so the maxima are computed while the data is still in cache.
+
+   Stretched velocity meshes are mapped in the index units of the 
+   intersections, where the cell edges and centres of a stretched 
+   coordinate are not integers (see computeCellEdges). The intersections 
+   are affine in these units, so they need no changes. The reconstructions 
+   assume equal neighbour widths, which only holds inside a block, and 
+   mapped values are scaled by the ratio of source and target cell widths 
+   to conserve mass.
    
 */
 bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
             vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer,
             Realv intersection, Realv intersection_di, Realv intersection_dj,Realv intersection_dk,
-            uint dimension) {
+            uint dimension,const Realf columnSkipThreshold,std::vector<Realf>* blockMaxValues) {
    no_subnormals();
 
    Realv dv,v_min;
    Realv is_temp;
    uint max_v_length;
+   uint i_dimension,j_dimension; /*< velocity coordinates of the solver internal (transposed) i and j*/
    uint block_indices_to_id[3]; /*< used when computing id of target block */
    uint cell_indices_to_id[3]; /*< used when computing id of target cell in block*/
    unsigned char cellid_transpose[WID3]; /*< defines the transpose for the solver internal (transposed) id: i + j*WID + k*WID2 to actual one*/
@@ -182,6 +280,8 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
       is_temp=intersection_di;
       intersection_di=intersection_dk;
       intersection_dk=is_temp;
+      i_dimension = 2;
+      j_dimension = 1;
 
       /*set values in array that is used to convert block indices to id using a dot product*/
       block_indices_to_id[0] = vmesh.getGridLength(REFLEVEL)[0]*vmesh.getGridLength(REFLEVEL)[1];
@@ -200,6 +300,8 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
       is_temp=intersection_dj;
       intersection_dj=intersection_dk;
       intersection_dk=is_temp;
+      i_dimension = 0;
+      j_dimension = 2;
       
       /*set values in array that is used to convert block indices to id using a dot product*/
       block_indices_to_id[0]=1;
@@ -212,6 +314,9 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
       cell_indices_to_id[2]=WID;
       break;
     case 2:
+      i_dimension = 0;
+      j_dimension = 1;
+
       /*set values in array that is used to convert block indices to id using a dot product*/
       block_indices_to_id[0]=1;
       block_indices_to_id[1] = vmesh.getGridLength(REFLEVEL)[0];
@@ -239,7 +344,15 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
    
    const Realv i_dv=1.0/dv;
 
-   // sort blocks according to dimension, and divide them into columns
+   // Cell edges of stretched coordinates in the index units of the 
+   // intersections, empty for uniform coordinates
+   std::vector<Realv> cellEdges_i,cellEdges_j,cellEdges_k;
+   computeCellEdges(vmesh,i_dimension,cellEdges_i);
+   computeCellEdges(vmesh,j_dimension,cellEdges_j);
+   computeCellEdges(vmesh,dimension,cellEdges_k);
+   const bool stretched_k = cellEdges_k.size() > 0;
+
+   // sort block local IDs according to dimension, and divide them into columns
    vmesh::LocalID* blocks = new vmesh::LocalID[vmesh.size()];
    std::vector<uint> columnBlockOffsets;
    std::vector<uint> columnNumBlocks;
@@ -260,6 +373,14 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
    vmesh::LocalID previous_target_block = vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>::invalidLocalID();
    Realf *target_block_data = NULL;
 
+   // Local IDs of the target blocks of the current column set. Blocks 
+   // that are not targeted are zero after loadColumnBlockData.
+   std::vector<vmesh::LocalID> setTargetLIDs;
+   if (blockMaxValues != NULL) blockMaxValues->assign(vmesh.size(),0.0);
+
+   // Maximum absolute value in each column, used to skip (nearly) empty columns
+   std::vector<Realf> columnMaxValues(columnNumBlocks.size());
+
    // loop over block column sets  (all columns along the dimension with the other dimensions being equal )
    for( uint setIndex=0; setIndex< setColumnOffsets.size(); ++setIndex) {
 
@@ -267,8 +388,8 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
       uint valuesColumnOffset = 0; //offset to values array for data in a column in this set
       for(uint columnIndex = setColumnOffsets[setIndex]; columnIndex < setColumnOffsets[setIndex] + setNumColumns[setIndex] ; columnIndex ++){
          const vmesh::LocalID n_cblocks = columnNumBlocks[columnIndex];
-         vmesh::GlobalID* cblocks = blocks + columnBlockOffsets[columnIndex]; //column blocks
-         loadColumnBlockData(vmesh, blockContainer, cblocks, n_cblocks, values + valuesColumnOffset, cellid_transpose);
+         vmesh::LocalID* cblocks = blocks + columnBlockOffsets[columnIndex]; //column blocks
+         columnMaxValues[columnIndex] = loadColumnBlockData(blockContainer, cblocks, n_cblocks, values + valuesColumnOffset, cellid_transpose);
          valuesColumnOffset += (n_cblocks + 2) * (WID3/VECL); // there are WID3/VECL elements of type Vec per block
       }
 
@@ -276,13 +397,20 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
       valuesColumnOffset = 0; //offset to values array for data in a column in this set
       for(uint columnIndex = setColumnOffsets[setIndex]; columnIndex < setColumnOffsets[setIndex] + setNumColumns[setIndex] ; columnIndex ++){
          const vmesh::LocalID n_cblocks = columnNumBlocks[columnIndex];
-         vmesh::GlobalID* cblocks = blocks + columnBlockOffsets[columnIndex]; //column blocks
+         vmesh::LocalID* cblocks = blocks + columnBlockOffsets[columnIndex]; //column blocks
+
+         // Nothing to map in an empty column, its source data has already been zeroed
+         if (columnMaxValues[columnIndex] == 0.0) {
+            valuesColumnOffset += (n_cblocks + 2) * (WID3/VECL);
+            continue;
+         }
+         const bool lowValueColumn = columnMaxValues[columnIndex] < columnSkipThreshold;
       
          // compute the common indices for this block column set
          //First block in column
          velocity_block_indices_t block_indices_begin;
          uint8_t refLevel;
-         vmesh.getIndices(cblocks[0],refLevel,block_indices_begin[0],block_indices_begin[1],block_indices_begin[2]);
+         vmesh.getIndices(vmesh.getGlobalID(cblocks[0]),refLevel,block_indices_begin[0],block_indices_begin[1],block_indices_begin[2]);
          uint temp;
          // Switch block indices according to dimensions, the algorithm has
          // been written for integrating along z.
@@ -343,46 +471,105 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
                index (i in vector)
             */
        
+            Vec i_centres = block_indices_begin[0] * WID + to_realv(i_indices);
+            Vec j_centres = block_indices_begin[1] * WID + to_realv(j_indices);
+            if (cellEdges_i.size() > 0) i_centres = cellCentres(cellEdges_i,block_indices_begin[0] * WID,i_indices);
+            if (cellEdges_j.size() > 0) j_centres = cellCentres(cellEdges_j,block_indices_begin[1] * WID,j_indices);
             const Vec intersection_min =
                intersection +
-               (block_indices_begin[0] * WID + to_realv(i_indices)) * intersection_di + 
-               (block_indices_begin[1] * WID + to_realv(j_indices)) * intersection_dj;
+               i_centres * intersection_di + 
+               j_centres * intersection_dj;
 
             /*compute some initial values, that are used to set up the
              * shifting of values as we go through all blocks in
              * order. See comments where they are shifted for
              * explanations of their meaning*/
-            Vec v_r((WID * block_indices_begin[2]) * dv + v_min);
-            Veci lagrangian_gk_r=truncate_to_int((v_r-intersection_min)/intersection_dk);
-         
+            const uint k_begin = WID * block_indices_begin[2];
+            Vec v_r(k_begin * dv + v_min);
+            Veci lagrangian_gk_r;
+            if (stretched_k) {
+               v_r = Vec(cellEdges_k[k_begin] * dv + v_min);
+               lagrangian_gk_r = cellIndex(cellEdges_k,(v_r-intersection_min)/intersection_dk);
+            } else {
+               lagrangian_gk_r = truncate_to_int((v_r-intersection_min)/intersection_dk);
+            }
+
+            // values + i_pcolumnv(n_cblocks, -1, j, 0) is the starting point of the column data for fixed j
+            // k + WID is the index where we have stored k index, WID amount of padding.
+            Vec * const columnValues = values + valuesColumnOffset + i_pcolumnv(j, 0, -1, n_cblocks);
+
+            // Unfiltered face estimates on the right face of the previous
+            // cell, which are the left face estimates of the next one.
+            #ifdef ACC_SEMILAG_PPM
+            Vec fv_r;
+            if (!lowValueColumn) compute_left_face_value(columnValues, WID, h4, fv_r);
+            #endif
+            #ifdef ACC_SEMILAG_PQM
+            Vec fv_r, fd_r;
+            if (!lowValueColumn) {
+               compute_left_face_value(columnValues, WID, h8, fv_r);
+               compute_left_face_derivative(columnValues, WID, h8, fd_r);
+            }
+            #endif
+
             // loop through all blocks in column and compute the mapping as integrals.
             for (uint k=0; k < WID * n_cblocks; ++k ){
                // Compute reconstructions 
-               // values + i_pcolumnv(n_cblocks, -1, j, 0) is the starting point of the column data for fixed j
-               // k + WID is the index where we have stored k index, WID amount of padding.
                #ifdef ACC_SEMILAG_PLM
                Vec a[2];
-               compute_plm_coeff(values + valuesColumnOffset + i_pcolumnv(j, 0, -1, n_cblocks), k + WID , a);
                #endif
                #ifdef ACC_SEMILAG_PPM
                Vec a[3];
-               compute_ppm_coeff(values + valuesColumnOffset + i_pcolumnv(j, 0, -1, n_cblocks), h4, k + WID, a);
                #endif
                #ifdef ACC_SEMILAG_PQM
                Vec a[5];
-               compute_pqm_coeff(values + valuesColumnOffset + i_pcolumnv(j, 0, -1, n_cblocks), h8, k + WID, a);
                #endif
+               if (lowValueColumn) {
+                  // Piecewise constant, values far below the sparsity threshold
+                  // only need to end up with their mass in the right place
+                  a[0] = columnValues[k + WID];
+                  for (uint c=1; c<sizeof(a)/sizeof(Vec); ++c) a[c] = Vec(0.0);
+               } else {
+                  #ifdef ACC_SEMILAG_PLM
+                  compute_plm_coeff(columnValues, k + WID , a);
+                  #endif
+                  #ifdef ACC_SEMILAG_PPM
+                  const Vec fv_l = fv_r;
+                  compute_left_face_value(columnValues, k + WID + 1, h4, fv_r);
+                  compute_ppm_coeff_from_faces(columnValues, k + WID, fv_l, fv_r, a);
+                  #endif
+                  #ifdef ACC_SEMILAG_PQM
+                  const Vec fv_l = fv_r;
+                  const Vec fd_l = fd_r;
+                  compute_left_face_value(columnValues, k + WID + 1, h8, fv_r);
+                  compute_left_face_derivative(columnValues, k + WID + 1, h8, fd_r);
+                  compute_pqm_coeff_from_faces(columnValues, k + WID, fv_l, fv_r, fd_l, fd_r, a);
+                  #endif
+               }
                
                // set the initial value for the integrand at the boundary at v = 0 
                // (in reduced cell units), this will be shifted to target_density_1, see below.
                Vec target_density_r(0.0);
                // v_l, v_r are the left and right velocity coordinates of source cell. Left is the old right.
+               // i_dv_k is the inverse width of the source cell, and width_k its width in index units.
                Vec v_l = v_r; 
-               v_r += dv;
+               Realv i_dv_k = i_dv;
+               Realv width_k = 1.0;
+               if (stretched_k) {
+                  width_k = cellEdges_k[k_begin + k + 1] - cellEdges_k[k_begin + k];
+                  i_dv_k = i_dv / width_k;
+                  v_r = Vec(cellEdges_k[k_begin + k + 1] * dv + v_min);
+               } else {
+                  v_r += dv;
+               }
                // left(l) and right(r) k values (global index) in the target
                // Lagrangian grid, the intersecting cells. Again old right is new left.
                const Veci lagrangian_gk_l = lagrangian_gk_r;
-               lagrangian_gk_r = truncate_to_int((v_r-intersection_min)/intersection_dk);
+               if (stretched_k) {
+                  lagrangian_gk_r = cellIndex(cellEdges_k,(v_r-intersection_min)/intersection_dk);
+               } else {
+                  lagrangian_gk_r = truncate_to_int((v_r-intersection_min)/intersection_dk);
+               }
             
                Veci gk(lagrangian_gk_l);
                while (horizontal_or(gk <= lagrangian_gk_r)){
@@ -400,7 +587,9 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
                   //v_1 and v_2 normalized to be between 0 and 1 in the cell.
                   //For vector elements where gk is already larger than needed (lagrangian_gk_r), v_2=v_1=v_r and thus the value is zero.
 
-                  const Vec v_norm_r = (min(to_realv(gk + 1) * intersection_dk + intersection_min, v_r) - v_l) * i_dv;
+                  Vec gk_edge_r = to_realv(gk + 1);
+                  if (stretched_k) gk_edge_r = cellEdge(cellEdges_k,gk + 1);
+                  const Vec v_norm_r = (min(gk_edge_r * intersection_dk + intersection_min, v_r) - v_l) * i_dv_k;
                   /*shift, old right is new left*/
                   const Vec target_density_l = target_density_r;
 
@@ -420,7 +609,12 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
                   #endif
 
                   // total value of integrand
-                  const Vec target_density = target_density_r - target_density_l;
+                  Vec target_density = target_density_r - target_density_l;
+
+                  // Mass of the source cell is spread over target cells of different width
+                  if (stretched_k) {
+                     target_density = target_density * (Vec(width_k) / (gk_edge_r - cellEdge(cellEdges_k,gk)));
+                  }
 
                   //store values, one element at a time
                   for (int target_i=0; target_i < VECL; ++target_i) {
@@ -448,6 +642,7 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
                                target_block_data = blockContainer.getNullData();
                            } else {
                                target_block_data = blockContainer.getData(tblockLID);
+                               if (blockMaxValues != NULL) setTargetLIDs.push_back(tblockLID);
                            }
                         }
 
@@ -463,7 +658,22 @@ bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
          }
          valuesColumnOffset += (n_cblocks + 2) * (WID3/VECL) ;// there are WID3/VECL elements of type Vec per block    
       }
+
+      // target blocks of this set are final, store their maximum values
+      if (blockMaxValues != NULL) {
+         std::sort(setTargetLIDs.begin(),setTargetLIDs.end());
+         setTargetLIDs.erase(std::unique(setTargetLIDs.begin(),setTargetLIDs.end()),setTargetLIDs.end());
+         if (blockMaxValues->size() < vmesh.size()) blockMaxValues->resize(vmesh.size(),0.0);
+         for (size_t b=0; b<setTargetLIDs.size(); ++b) {
+            const Realf* __restrict__ data = blockContainer.getData(setTargetLIDs[b]);
+            Realf maxValue = data[0];
+            for (uint i=1; i<WID3; ++i) maxValue = max(maxValue,data[i]);
+            (*blockMaxValues)[setTargetLIDs[b]] = maxValue;
+         }
+         setTargetLIDs.clear();
+      }
    }
+   if (blockMaxValues != NULL) blockMaxValues->resize(vmesh.size(),0.0);
    delete [] blocks;
    return true;
 }
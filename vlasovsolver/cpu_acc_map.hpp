@@ -30,6 +30,6 @@
 bool map_1d(vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
             vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer,
             Realv intersection,Realv intersection_di,Realv intersection_dj,Realv intersection_dk,
-            uint dimension);
+            uint dimension,const Realf columnSkipThreshold,std::vector<Realf>* blockMaxValues=NULL);
 
 #endif
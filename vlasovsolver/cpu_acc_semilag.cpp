@@ -89,6 +89,10 @@ void cpu_accelerate_cell(SpatialCell* spatial_cell,
 
    vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh    = spatial_cell->get_velocity_mesh(popID);
    vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer = spatial_cell->get_velocity_blocks(popID);
+   // Filled by the last mapping, used instead of a separate scan when updating the block content lists
+   std::vector<Realf>& blockMaxValues = spatial_cell->get_velocity_block_max_values(popID);
+   // Columns below this value are mapped with a cheap piecewise constant reconstruction
+   const Realf columnSkipThreshold = Parameters::accColumnSkipFraction*spatial_cell->getVelocityBlockMinValue(popID);
 
    // compute transform, forward in time and backward in time
    phiprof::start("compute-transform");
@@ -114,9 +118,9 @@ void cpu_accelerate_cell(SpatialCell* spatial_cell,
                                     intersection_z,intersection_z_di,intersection_z_dj,intersection_z_dk);
           phiprof::stop("compute-intersections");
           phiprof::start("compute-mapping");
-          map_1d(vmesh,blockContainer,intersection_x,intersection_x_di,intersection_x_dj,intersection_x_dk,0); // map along x
-          map_1d(vmesh,blockContainer,intersection_y,intersection_y_di,intersection_y_dj,intersection_y_dk,1); // map along y
-          map_1d(vmesh,blockContainer,intersection_z,intersection_z_di,intersection_z_dj,intersection_z_dk,2); // map along z
+          map_1d(vmesh,blockContainer,intersection_x,intersection_x_di,intersection_x_dj,intersection_x_dk,0,columnSkipThreshold); // map along x
+          map_1d(vmesh,blockContainer,intersection_y,intersection_y_di,intersection_y_dj,intersection_y_dk,1,columnSkipThreshold); // map along y
+          map_1d(vmesh,blockContainer,intersection_z,intersection_z_di,intersection_z_dj,intersection_z_dk,2,columnSkipThreshold,&blockMaxValues); // map along z
           phiprof::stop("compute-mapping");
           break;
           
@@ -132,9 +136,9 @@ void cpu_accelerate_cell(SpatialCell* spatial_cell,
       
           phiprof::stop("compute-intersections");
           phiprof::start("compute-mapping");
-          map_1d(vmesh,blockContainer,intersection_y,intersection_y_di,intersection_y_dj,intersection_y_dk,1); // map along y
-          map_1d(vmesh,blockContainer,intersection_z,intersection_z_di,intersection_z_dj,intersection_z_dk,2); // map along z
-          map_1d(vmesh,blockContainer,intersection_x,intersection_x_di,intersection_x_dj,intersection_x_dk,0); // map along x
+          map_1d(vmesh,blockContainer,intersection_y,intersection_y_di,intersection_y_dj,intersection_y_dk,1,columnSkipThreshold); // map along y
+          map_1d(vmesh,blockContainer,intersection_z,intersection_z_di,intersection_z_dj,intersection_z_dk,2,columnSkipThreshold); // map along z
+          map_1d(vmesh,blockContainer,intersection_x,intersection_x_di,intersection_x_dj,intersection_x_dk,0,columnSkipThreshold,&blockMaxValues); // map along x
           phiprof::stop("compute-mapping");
           break;
 
@@ -149,12 +153,13 @@ void cpu_accelerate_cell(SpatialCell* spatial_cell,
                                     intersection_y,intersection_y_di,intersection_y_dj,intersection_y_dk);
           phiprof::stop("compute-intersections");
           phiprof::start("compute-mapping");
-          map_1d(vmesh,blockContainer,intersection_z,intersection_z_di,intersection_z_dj,intersection_z_dk,2); // map along z
-          map_1d(vmesh,blockContainer,intersection_x,intersection_x_di,intersection_x_dj,intersection_x_dk,0); // map along x
-          map_1d(vmesh,blockContainer,intersection_y,intersection_y_di,intersection_y_dj,intersection_y_dk,1); // map along y
+          map_1d(vmesh,blockContainer,intersection_z,intersection_z_di,intersection_z_dj,intersection_z_dk,2,columnSkipThreshold); // map along z
+          map_1d(vmesh,blockContainer,intersection_x,intersection_x_di,intersection_x_dj,intersection_x_dk,0,columnSkipThreshold); // map along x
+          map_1d(vmesh,blockContainer,intersection_y,intersection_y_di,intersection_y_dj,intersection_y_dk,1,columnSkipThreshold,&blockMaxValues); // map along y
           phiprof::stop("compute-mapping");
           break;
    }
+   spatial_cell->set_velocity_block_max_values_valid(popID);
 
    if (Parameters::prepareForRebalance == true) {
       spatial_cell->parameters[CellParams::LBWEIGHTCOUNTER] += (MPI_Wtime() - t1);
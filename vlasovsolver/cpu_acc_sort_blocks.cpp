@@ -37,16 +37,17 @@ inline bool paircomparator( const std::pair<uint, uint> & l, const std::pair<uin
 }
 
 /*
-   This function returns a sorted list of blocks in a cell.
+   This function returns a sorted list of the local IDs of blocks in a cell.
 
    The sorted list is sorted according to the location, along the given dimension.
+   Local IDs are returned so that block data can be accessed without global ID lookups.
    
 */
 #warning "unfinished documentation"
 void sortBlocklistByDimension( //const spatial_cell::SpatialCell* spatial_cell,
                                const vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
                                const uint dimension,
-                               uint* blocks,
+                               vmesh::LocalID* blocks,
                                std::vector<uint> & columnBlockOffsets,
                                std::vector<uint> & columnNumBlocks,
                                std::vector<uint> & setColumnOffsets,
@@ -59,7 +60,7 @@ void sortBlocklistByDimension( //const spatial_cell::SpatialCell* spatial_cell,
    const uint8_t REFLEVEL = 0;
    
    // Copy block data to vector
-   std::vector<std::pair<vmesh::GlobalID,vmesh::GlobalID> > block_pairs;
+   std::vector<std::pair<vmesh::GlobalID,vmesh::LocalID> > block_pairs;
    block_pairs.resize( nBlocks );
    for (vmesh::LocalID i = 0; i < nBlocks; ++i ) {
       //const vmesh::GlobalID block = spatial_cell->get_velocity_block_global_id(i);
@@ -67,7 +68,7 @@ void sortBlocklistByDimension( //const spatial_cell::SpatialCell* spatial_cell,
       switch( dimension ) {
        case 0: {
           const vmesh::GlobalID blockId_mapped = block; // Mapping the block id to different coordinate system if dimension is not zero:
-          block_pairs[i] = std::make_pair( blockId_mapped, block );
+          block_pairs[i] = std::make_pair( blockId_mapped, i );
        }
          break;
        case 1: {
@@ -89,7 +90,7 @@ void sortBlocklistByDimension( //const spatial_cell::SpatialCell* spatial_cell,
                   = block - (x_index + y_index*vmesh.getGridLength(REFLEVEL)[0])
                   + y_index 
                   + x_index * vmesh.getGridLength(REFLEVEL)[1];
-          block_pairs[i] = std::make_pair( blockId_mapped, block );
+          block_pairs[i] = std::make_pair( blockId_mapped, i );
        }
          break;
        case 2: {
@@ -112,7 +113,7 @@ void sortBlocklistByDimension( //const spatial_cell::SpatialCell* spatial_cell,
             = z_index 
             + y_index*vmesh.getGridLength(REFLEVEL)[2]
             + x_index*vmesh.getGridLength(REFLEVEL)[1]*vmesh.getGridLength(REFLEVEL)[2];
-          block_pairs[i] = std::make_pair( blockId_mapped, block );
+          block_pairs[i] = std::make_pair( blockId_mapped, i );
        }
          break;
       }
@@ -132,7 +133,7 @@ void sortBlocklistByDimension( //const spatial_cell::SpatialCell* spatial_cell,
        // identifies a particular block in a column (along the dimension)
        vmesh::LocalID dimension_id = block_pairs[i].first % vmesh.getGridLength(REFLEVEL)[dimension];
       
-       //sorted list
+       //sorted list of local IDs
        blocks[i] = block_pairs[i].second;
 
       if ( i > 0 &&  ( column_id != prev_column_id || dimension_id != (prev_dimension_id + 1) )){
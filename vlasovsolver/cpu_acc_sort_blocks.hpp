@@ -32,7 +32,7 @@
 void sortBlocklistByDimension( //const spatial_cell::SpatialCell* spatial_cell, 
                                const vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh,
                                const uint dimension,
-                               uint* blocks,
+                               vmesh::LocalID* blocks,
                                std::vector<uint> & columnBlockOffsets,
                                std::vector<uint> & columnNumBlocks,
                                std::vector<uint> & setColumnOffsets,
@@ -140,36 +140,47 @@ Eigen::Transform<Real,3,Eigen::Affine> compute_acceleration_transformation(
 
    // note, we assume q is positive (pretty good assumption though)
    const Real substeps_radians = -(2.0*M_PI*dt/fabs(gyro_period))/bulk_velocity_substeps; // how many radians each substep is.
-   const Real substeps_dt=dt/bulk_velocity_substeps; /*!< how many s each substep is*/
    Eigen::Matrix<Real,3,1> EgradPe(
       spatial_cell->parameters[CellParams::EXGRADPE],
       spatial_cell->parameters[CellParams::EYGRADPE],
       spatial_cell->parameters[CellParams::EZGRADPE]);
 
-   for (uint i=0; i<bulk_velocity_substeps; ++i) {
-      // rotation origin is the point through which we place our rotation axis (direction of which is unitB).
-      // first add bulk velocity (using the total transform computed this far.
-      Eigen::Matrix<Real,3,1> rotation_pivot(total_transform*bulk_velocity);
-      
-      //include lorentzHallTerm (we should include, always)      
-      rotation_pivot[0]-= hallPrefactor*(dBZdy - dBYdz);
-      rotation_pivot[1]-= hallPrefactor*(dBXdz - dBZdx);
-      rotation_pivot[2]-= hallPrefactor*(dBYdx - dBXdy);
+   // Offset of the rotation pivot from the bulk velocity, lorentzHallTerm (we should include, always)
+   Eigen::Matrix<Real,3,1> hall_offset;
+   hall_offset[0] = -hallPrefactor*(dBZdy - dBYdz);
+   hall_offset[1] = -hallPrefactor*(dBXdz - dBZdx);
+   hall_offset[2] = -hallPrefactor*(dBYdx - dBXdy);
 
 #warning Is particle charge sign taken correctly into account here?
-      
-      // add to transform matrix the small rotation around  pivot
-      // when added like this, and not using *= operator, the transformations
-      // are in the correct order
-      total_transform = Translation<Real,3>(-rotation_pivot)*total_transform;
-      total_transform = AngleAxis<Real>(substeps_radians,unit_B)*total_transform;
-      total_transform = Translation<Real,3>(rotation_pivot)*total_transform;
-
-      // Electron pressure gradient term
-      if(Parameters::ohmGradPeTerm > 0) {
-         total_transform=Translation<Real,3>( (fabs(physicalconstants::CHARGE)/physicalconstants::MASS_PROTON) * EgradPe * substeps_dt) * total_transform;
-      }
+
+   /* The transformation is the composition of bulk_velocity_substeps small
+    * rotations R (angle substeps_radians around unit_B), each about the pivot
+    * p_i = T_i*bulk_velocity + hall_offset, followed by the gradPe shift g*dt_sub.
+    * Writing T_i(v) = A_i v + b_i one gets A_{i+1} = R A_i and
+    * b_{i+1} = b_i + (I-R)(A_i*bulk_velocity + hall_offset) + g*dt_sub,
+    * which telescopes to
+    *   A_N = R^N
+    *   b_N = (I-R^N)*bulk_velocity + N*(I-R)*hall_offset + g*dt.
+    * This is the same transform the substepped composition produces (up to
+    * rounding), evaluated at constant cost independent of the gyration angle.
+    */
+   const Eigen::Matrix<Real,3,3> identity = Eigen::Matrix<Real,3,3>::Identity();
+   const Eigen::Matrix<Real,3,3> substep_rotation
+      = AngleAxis<Real>(substeps_radians,unit_B).toRotationMatrix();
+   const Eigen::Matrix<Real,3,3> total_rotation
+      = AngleAxis<Real>(substeps_radians*bulk_velocity_substeps,unit_B).toRotationMatrix();
+
+   Eigen::Matrix<Real,3,1> translation
+      = (identity - total_rotation)*bulk_velocity
+      + ((Real)bulk_velocity_substeps)*((identity - substep_rotation)*hall_offset);
+
+   // Electron pressure gradient term
+   if(Parameters::ohmGradPeTerm > 0) {
+      translation += (fabs(physicalconstants::CHARGE)/physicalconstants::MASS_PROTON) * EgradPe * dt;
    }
 
+   total_transform.linear() = total_rotation;
+   total_transform.translation() = translation;
+
    return total_transform;
 }
@@ -182,46 +182,64 @@ inline void compute_h3_left_face_derivative(const Vec * const values, uint k, Ve
 }
 
 
-/*Filters in section 2.6.1 of white et al. to be used for PQM
-  1) Checks for extrema and flattens them
-  2) Makes face values bounded
-  3) Makes sure face slopes are consistent with PLM slope
-*/
-inline void compute_filtered_face_values_derivatives(const Vec * const values,uint k, face_estimate_order order,
-                                                        Vec &fv_l, Vec &fv_r, Vec &fd_l, Vec &fd_r){   
+/*!
+  Compute left face value with the given order. Not available for h5, whose
+  face values are not shared between neighbouring cells.
 
+  Right face value can be obtained as left face value of cell k + 1, which lets
+  a sweep along a column reuse the previous cell's right face estimate.
+*/
+inline void compute_left_face_value(const Vec * const values, uint k, face_estimate_order order, Vec &fv_l){
    switch(order){
        case h4:
           compute_h4_left_face_value(values, k, fv_l);
-          compute_h4_left_face_value(values, k + 1, fv_r);
+          break;
+       default:
+       case h6:
+          compute_h6_left_face_value(values, k, fv_l);
+          break;
+       case h8:
+          compute_h8_left_face_value(values, k, fv_l);
+          break;
+   }
+}
+
+/*!
+  Compute left face derivative matching the face value estimate of the given order.
+
+  Right face derivative can be obtained as left face derivative of cell k + 1.
+*/
+inline void compute_left_face_derivative(const Vec * const values, uint k, face_estimate_order order, Vec &fd_l){
+   switch(order){
+       case h4:
           compute_h3_left_face_derivative(values, k, fd_l);
-          compute_h3_left_face_derivative(values, k + 1, fd_r);
           break;
        case h5:
-          compute_h5_face_values(values, k, fv_l, fv_r);
           compute_h4_left_face_derivative(values, k, fd_l);
-          compute_h4_left_face_derivative(values, k + 1, fd_r);
           break;
        default:
        case h6:
-          compute_h6_left_face_value(values, k, fv_l);
-          compute_h6_left_face_value(values, k + 1, fv_r);   
           compute_h5_left_face_derivative(values, k, fd_l);
-          compute_h5_left_face_derivative(values, k + 1, fd_r);
           break;
        case h8:
-          compute_h8_left_face_value(values, k, fv_l);
-          compute_h8_left_face_value(values, k + 1, fv_r);   
           compute_h7_left_face_derivative(values, k, fd_l);
-          compute_h7_left_face_derivative(values, k + 1, fd_r);
           break;
    }
-   
-   Vec slope_abs,slope_sign;
-   slope_limiter(values[k -1], values[k], values[k + 1], slope_abs, slope_sign);
-   
+}
+
+/*Filters in section 2.6.1 of white et al. to be used for PQM, applied
+  to already computed face value and derivative estimates of cell k
+  1) Checks for extrema and flattens them
+  2) Makes face values bounded
+  3) Makes sure face slopes are consistent with PLM slope
+*/
+inline void filter_face_values_derivatives(const Vec * const values,uint k,
+                                           Vec &fv_l, Vec &fv_r, Vec &fd_l, Vec &fd_r){
+   const Vec slope = slope_limiter(values[k -1], values[k], values[k + 1]);
+   const Vec slope_sign = select(slope > 0, Vec(1.0), Vec(-1.0));
+
    //check for extrema, flatten if it is
-   Vecb is_extrema = (slope_abs == Vec(0.0));
+   Vecb is_extrema = (slope == Vec(0.0));
    if(horizontal_or(is_extrema)) {
       fv_r = select(is_extrema, values[k], fv_r);
       fv_l = select(is_extrema, values[k], fv_l);
@@ -233,51 +251,29 @@ inline void compute_filtered_face_values_derivatives(const Vec * const values,ui
    Vecb filter = (values[k -1] - fv_l) * (fv_l - values[k]) < 0 || slope_sign * fd_l < 0.0;
    if(horizontal_or (filter)) {  
       //Go to linear (PLM) estimates if not ok (this is always ok!)
-      fv_l=select(filter, values[k ] - slope_sign * 0.5 * slope_abs, fv_l);
-      fd_l=select(filter, slope_sign * slope_abs, fd_l);
+      fv_l=select(filter, values[k ] - 0.5 * slope, fv_l);
+      fd_l=select(filter, slope, fd_l);
    }
    
    //Fix right face if needed; boundary value is not bounded or slope is not consistent 
    filter = (values[k + 1] - fv_r) * (fv_r - values[k]) < 0 || slope_sign * fd_r < 0.0;
    if(horizontal_or (filter)) {  
       //Go to linear (PLM) estimates if not ok (this is always ok!)
-      fv_r=select(filter, values[k] + slope_sign * 0.5 * slope_abs, fv_r);
-      fd_r=select(filter, slope_sign * slope_abs, fd_r);
+      fv_r=select(filter, values[k] + 0.5 * slope, fv_r);
+      fd_r=select(filter, slope, fd_r);
    }
 }
 
-
-
-
-/*Filters in section 2.6.1 of white et al. to be used for PPM
+/*Filters in section 2.6.1 of white et al. to be used for PPM, applied
+  to already computed face value estimates of cell k
   1) Checks for extrema and flattens them
   2) Makes face values bounded
-  3) Makes sure face slopes are consistent with PLM slope
 */
-inline void compute_filtered_face_values(const Vec * const values,uint k, face_estimate_order order, Vec &fv_l, Vec &fv_r){   
-   switch(order){
-       case h4:
-          compute_h4_left_face_value(values, k, fv_l);
-          compute_h4_left_face_value(values, k + 1, fv_r);
-          break;
-       case h5:
-          compute_h5_face_values(values, k, fv_l, fv_r);
-          break;
-       default:
-       case h6:
-          compute_h6_left_face_value(values, k, fv_l);
-          compute_h6_left_face_value(values, k + 1, fv_r);   
-          break;
-       case h8:
-          compute_h8_left_face_value(values, k, fv_l);
-          compute_h8_left_face_value(values, k + 1, fv_r);   
-          break;
-   }
-   Vec slope_abs,slope_sign;
-   slope_limiter(values[k -1], values[k], values[k + 1], slope_abs, slope_sign);
-   
+inline void filter_face_values(const Vec * const values,uint k, Vec &fv_l, Vec &fv_r){
+   const Vec slope = slope_limiter(values[k -1], values[k], values[k + 1]);
+
    //check for extrema, flatten if it is
-   Vecb is_extrema = (slope_abs == Vec(0.0));
+   Vecb is_extrema = (slope == Vec(0.0));
    if(horizontal_or(is_extrema)) {
       fv_r = select(is_extrema, values[k], fv_r);
       fv_l = select(is_extrema, values[k], fv_l);
@@ -287,15 +283,40 @@ inline void compute_filtered_face_values(const Vec * const values,uint k, face_e
    Vecb filter = (values[k -1] - fv_l) * (fv_l - values[k]) < 0 ;
    if(horizontal_or (filter)) {  
       //Go to linear (PLM) estimates if not ok (this is always ok!)
-      fv_l=select(filter, values[k ] - slope_sign * 0.5 * slope_abs, fv_l);
+      fv_l=select(filter, values[k ] - 0.5 * slope, fv_l);
    }
 
    //Fix  face if needed; boundary value is not bounded    
    filter = (values[k + 1] - fv_r) * (fv_r - values[k]) < 0;
    if(horizontal_or (filter)) {  
       //Go to linear (PLM) estimates if not ok (this is always ok!)
-      fv_r=select(filter, values[k] + slope_sign * 0.5 * slope_abs, fv_r);
+      fv_r=select(filter, values[k] + 0.5 * slope, fv_r);
+   }
+}
+
+/*Face value and derivative estimates of cell k, filtered for PQM*/
+inline void compute_filtered_face_values_derivatives(const Vec * const values,uint k, face_estimate_order order,
+                                                        Vec &fv_l, Vec &fv_r, Vec &fd_l, Vec &fd_r){   
+   if(order == h5) {
+      compute_h5_face_values(values, k, fv_l, fv_r);
+   } else {
+      compute_left_face_value(values, k, order, fv_l);
+      compute_left_face_value(values, k + 1, order, fv_r);
+   }
+   compute_left_face_derivative(values, k, order, fd_l);
+   compute_left_face_derivative(values, k + 1, order, fd_r);
+   filter_face_values_derivatives(values, k, fv_l, fv_r, fd_l, fd_r);
+}
+
+/*Face value estimates of cell k, filtered for PPM*/
+inline void compute_filtered_face_values(const Vec * const values,uint k, face_estimate_order order, Vec &fv_l, Vec &fv_r){   
+   if(order == h5) {
+      compute_h5_face_values(values, k, fv_l, fv_r);
+   } else {
+      compute_left_face_value(values, k, order, fv_l);
+      compute_left_face_value(values, k + 1, order, fv_r);
    }
+   filter_face_values(values, k, fv_l, fv_r);
 }
 
 #endif
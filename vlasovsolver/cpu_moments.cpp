@@ -58,6 +58,7 @@ void calculateCellMoments(spatial_cell::SpatialCell* cell,
         cell->parameters[CellParams::P_11] = 0.0;
         cell->parameters[CellParams::P_22] = 0.0;
         cell->parameters[CellParams::P_33] = 0.0;
+        cell->parameters[CellParams::RHOQ] = 0.0;
     }
 
     // Loop over all particle species
@@ -86,6 +87,7 @@ void calculateCellMoments(spatial_cell::SpatialCell* cell,
           cell->parameters[CellParams::RHOVX] += array[1];
           cell->parameters[CellParams::RHOVY] += array[2];
           cell->parameters[CellParams::RHOVZ] += array[3];
+          cell->parameters[CellParams::RHOQ ] += getObjectWrapper().particleSpecies[popID].charge*array[0]/massRatio;
        } // for-loop over particle species
     }
 
@@ -124,6 +126,32 @@ void calculateCellMoments(spatial_cell::SpatialCell* cell,
     } // for-loop over particle species
 }
 
+/** Calculate the charge density of all particle populations in the given 
+ * spatial cell to CellParams::RHOQ. The charge density is also calculated 
+ * together with velocity moments, this function is only needed if the 
+ * moments were not calculated from the distribution function (e.g. after restart).
+ * @param cell Spatial cell.*/
+void calculateCellChargeDensity(spatial_cell::SpatialCell* cell) {
+    cell->parameters[CellParams::RHOQ] = 0.0;
+    for (int popID=0; popID<getObjectWrapper().particleSpecies.size(); ++popID) {
+       vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer = cell->get_velocity_blocks(popID);
+       if (blockContainer.size() == 0) continue;
+
+       const Realf* data       = blockContainer.getData();
+       const Real* blockParams = blockContainer.getParameters();
+
+       // Species' number density, massRatio=1
+       Real array[4];
+       for (int i=0; i<4; ++i) array[i] = 0.0;
+       for (vmesh::LocalID blockLID=0; blockLID<blockContainer.size(); ++blockLID) {
+          blockVelocityFirstMoments(data+blockLID*WID3,
+                                    blockParams+blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS,
+                                    1.0,array);
+       }
+       cell->parameters[CellParams::RHOQ] += getObjectWrapper().particleSpecies[popID].charge*array[0];
+    } // for-loop over particle species
+}
+
 /** Calculate zeroth, first, and (possibly) second bulk velocity moments for the 
  * given spatial cell. Additionally, for each species, calculate the maximum 
  * spatial time step so that CFL(spatial)=1. The calculated moments include 
@@ -155,6 +183,7 @@ void calculateMoments_R_maxdt(
              cell->parameters[CellParams::P_11_R] = 0.0;
              cell->parameters[CellParams::P_22_R] = 0.0;
              cell->parameters[CellParams::P_33_R] = 0.0;
+             cell->parameters[CellParams::RHOQ] = 0.0;
           }
 
           const Real dx = cell->parameters[CellParams::DX];
@@ -189,6 +218,7 @@ void calculateMoments_R_maxdt(
           for (int i=0; i<4; ++i) array[i] = 0.0;
 
           // Calculate species' contribution to first velocity moments
+          const Real massRatio = getObjectWrapper().particleSpecies[popID].mass / physicalconstants::MASS_PROTON;
           for (vmesh::LocalID blockLID=0; blockLID<blockContainer.size(); ++blockLID) {
              // compute maximum dt. Algorithm has a CFL condition, since it
              // is written only for the case where we have a stencil
@@ -213,7 +243,6 @@ void calculateMoments_R_maxdt(
                 cell->set_max_r_dt(popID,min(dt_max_cell,cell->get_max_r_dt(popID)));
              }
 
-             const Real massRatio = getObjectWrapper().particleSpecies[popID].mass / physicalconstants::MASS_PROTON;
              blockVelocityFirstMoments(data+blockLID*WID3,
                                        blockParams+blockLID*BlockParams::N_VELOCITY_BLOCK_PARAMS,
                                        massRatio,array);
@@ -224,6 +253,7 @@ void calculateMoments_R_maxdt(
           cell->parameters[CellParams::RHOVX_R] += array[1];
           cell->parameters[CellParams::RHOVY_R] += array[2];
           cell->parameters[CellParams::RHOVZ_R] += array[3];
+          cell->parameters[CellParams::RHOQ   ] += getObjectWrapper().particleSpecies[popID].charge*array[0]/massRatio;
        } // for-loop over spatial cells
     } // for-loop over particle species
 
@@ -302,6 +332,7 @@ void calculateMoments_V(
             cell->parameters[CellParams::P_11_V] = 0.0;
             cell->parameters[CellParams::P_22_V] = 0.0;
             cell->parameters[CellParams::P_33_V] = 0.0;
+            cell->parameters[CellParams::RHOQ] = 0.0;
          }
 
          vmesh::VelocityBlockContainer<vmesh::LocalID>& blockContainer = cell->get_velocity_blocks(popID);
@@ -327,6 +358,7 @@ void calculateMoments_V(
          cell->parameters[CellParams::RHOVX_V] += array[1];
          cell->parameters[CellParams::RHOVY_V] += array[2];
          cell->parameters[CellParams::RHOVZ_V] += array[3];         
+         cell->parameters[CellParams::RHOQ   ] += getObjectWrapper().particleSpecies[popID].charge*array[0]/massRatio;
       } // for-loop over spatial cells
    } // for-loop over particle species
 
@@ -45,6 +45,8 @@ void blockVelocitySecondMoments(const Realf* avgs,const Real* blockParams,const
                                 const int cp_rho,const int cp_rhovx,const int cp_rhovy,const int cp_rhovz,
                                 REAL* array);
 
+void calculateCellChargeDensity(SpatialCell* cell);
+
 void calculateMoments_R_maxdt(dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
                               const std::vector<CellID>& cells,
                               const bool& computeSecond);
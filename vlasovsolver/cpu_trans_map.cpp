@@ -30,6 +30,7 @@
 
 #include "../grid.h"
 #include "../object_wrapper.h"
+#include "../mpi_progress.h"
 #include "vec.h"
 #include "cpu_1d_plm.hpp"
 #include "cpu_1d_ppm.hpp"
@@ -43,7 +44,7 @@ void compute_spatial_source_neighbors(const dccrg::Dccrg<SpatialCell,dccrg::Cart
                                       const CellID& cellID,const uint dimension,SpatialCell **neighbors);
 void compute_spatial_target_neighbors(const dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
                                       const CellID& cellID,const uint dimension,SpatialCell **neighbors);
-void copy_trans_block_data(SpatialCell** source_neighbors,const vmesh::GlobalID blockGID,
+void copy_trans_block_data(SpatialCell** source_neighbors,const vmesh::LocalID* blockLIDs,
                            Vec* values,const unsigned char* const cellid_transpose,const int& popID);
 CellID get_spatial_neighbor(const dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
                             const CellID& cellID,const bool include_first_boundary_layer,
@@ -51,7 +52,7 @@ CellID get_spatial_neighbor(const dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geom
 SpatialCell* get_spatial_neighbor_pointer(const dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
                                           const CellID& cellID,const bool include_first_boundary_layer,
                                           const int spatial_di,const int spatial_dj,const int spatial_dk);
-void store_trans_block_data(SpatialCell** target_neighbors,const vmesh::GlobalID blockGID,
+void store_trans_block_data(SpatialCell** target_neighbors,const vmesh::LocalID* blockLIDs,
                             Vec* __restrict__ target_values,
                             const unsigned char* const cellid_transpose,const int& popID);
 
@@ -79,9 +80,70 @@ bool do_translate_cell(SpatialCell* SC){
       return true;
 }
 
+/** Create the GID-sorted block lists used by trans_map_1d to find the
+ * local IDs of a block in the neighboring cells. The velocity meshes do
+ * not change during translation, so the lists are valid for all three
+ * dimensions and must be created for all local and remote cells in the
+ * translation stencils.
+ * @param mpiGrid Parallel grid.
+ * @param cells Spatial cells in which the list is created.
+ * @param popID ID of the translated particle species.*/
+void createSortedBlockLists(
+        dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+        const vector<CellID>& cells,
+        const int& popID) {
+
+   phiprof::start("create-sorted-block-lists");
+   #pragma omp parallel for
+   for (size_t c=0; c<cells.size(); ++c) {
+      SpatialCell* spatial_cell = mpiGrid[cells[c]];
+      const vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh = spatial_cell->get_velocity_mesh(popID);
+      vector<pair<vmesh::GlobalID,vmesh::LocalID> >& list = spatial_cell->sorted_velocity_block_list;
+      list.resize(vmesh.size());
+      for (vmesh::LocalID blockLID=0; blockLID<vmesh.size(); ++blockLID) {
+         list[blockLID] = make_pair(vmesh.getGlobalID(blockLID),blockLID);
+      }
+      sort(list.begin(),list.end());
+   }
+   phiprof::stop("create-sorted-block-lists");
+}
+
+/** Release the memory of the sorted block lists created by createSortedBlockLists.
+ * @param mpiGrid Parallel grid.
+ * @param cells Spatial cells in which the list is cleared.*/
+void clearSortedBlockLists(
+        dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+        const vector<CellID>& cells) {
+   for (size_t c=0; c<cells.size(); ++c) {
+      vector<pair<vmesh::GlobalID,vmesh::LocalID> >().swap(mpiGrid[cells[c]]->sorted_velocity_block_list);
+   }
+}
+
+/** Find the local ID of a block in a GID-sorted block list. Consecutive
+ * calls with increasing GIDs walk the list forward from position, so a
+ * sweep over a sorted list of blocks is a merge without any hash lookups.
+ * @param list Sorted block list of the searched cell.
+ * @param position Current position in the list, updated by the call.
+ * @param blockGID Global ID of the searched block.
+ * @return Local ID of the block, or invalid local ID if it does not exist.*/
+inline vmesh::LocalID find_sorted_block_local_id(
+        const vector<pair<vmesh::GlobalID,vmesh::LocalID> >& list,
+        size_t& position,
+        const vmesh::GlobalID blockGID) {
+   if (position >= list.size() || list[position].first > blockGID) {
+      // Not a forward walk (first call, or blocks not visited in order), restart with bisection
+      position = lower_bound(list.begin(),list.end(),make_pair(blockGID,(vmesh::LocalID)0)) - list.begin();
+   } else {
+      while (position < list.size() && list[position].first < blockGID) ++position;
+   }
+   if (position < list.size() && list[position].first == blockGID) return list[position].second;
+   return vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>::invalidLocalID();
+}
+
 /** Create temporary target grid where we write the mapped values for
  * all cells in cells vector. In this non-AMR version it contains the
- * same blocks as the normal grid.
+ * same blocks as the normal grid. Storage left over from earlier 
+ * translations is reused, and the data is set to zero.
  * @param mpiGrid
  * @param cells .*/
 void createTargetGrid(
@@ -105,26 +167,32 @@ void createTargetGrid(
       // i.e., vmesh still points to the temporary mesh.
       vmesh = spatial_cell->get_velocity_mesh(popID);
 
-      // allocate space in block container and set block parameters
-      blockContainer.clear();
-      blockContainer.setSize(vmesh.size());
-
-      for (size_t b=0; b<vmesh.size(); ++b) {
-         vmesh::GlobalID blockGID = vmesh.getGlobalID(b);
-         Real* blockParams = blockContainer.getParameters(b);
-         blockParams[BlockParams::VXCRD] = spatial_cell->get_velocity_block_vx_min(popID,blockGID);
-         blockParams[BlockParams::VYCRD] = spatial_cell->get_velocity_block_vy_min(popID,blockGID);
-         blockParams[BlockParams::VZCRD] = spatial_cell->get_velocity_block_vz_min(popID,blockGID);
-         vmesh.getCellSize(blockGID,&(blockParams[BlockParams::DVX]));
+      // size the block container, reusing its previous allocation if possible
+      blockContainer.resetSize(vmesh.size());
+
+      // blocks are in the same order as in the source container, so the
+      // block parameters can be copied as they are
+      const vmesh::VelocityBlockContainer<vmesh::LocalID>& sourceContainer = spatial_cell->get_velocity_blocks(popID);
+      const Real* sourceParams = sourceContainer.getParameters();
+      Real* blockParams = blockContainer.getParameters();
+      for (size_t i=0; i<vmesh.size()*BlockParams::N_VELOCITY_BLOCK_PARAMS; ++i) {
+         blockParams[i] = sourceParams[i];
+      }
+
+      Realf* blockData = blockContainer.getData();
+      for (size_t i=0; i<vmesh.size()*VELOCITY_BLOCK_LENGTH; ++i) {
+         blockData[i] = 0;
       }
       
       if (Parameters::prepareForRebalance == true) 
          spatial_cell->get_cell_parameters()[CellParams::LBWEIGHTCOUNTER] += (MPI_Wtime()-t_start);
+      mpiprogress::poll();
    }
    phiprof::stop("create-target-grid");
 }
 
-/** Clear temporary target grid for all given cells.
+/** Clear temporary target grid for all given cells, releasing its memory.
+ * Not needed between translations, createTargetGrid reuses the storage.
  * @param mpiGrid Parallel grid.
  * @param cells Spatial cells in which mesh is cleared.*/
 void clearTargetGrid(
@@ -352,14 +420,14 @@ void compute_spatial_target_neighbors(const dccrg::Dccrg<SpatialCell,dccrg::Cart
  *
  * @param source_neighbors Array containing the VLASOV_STENCIL_WIDTH closest 
  * spatial neighbors of this cell in the propagated dimension.
- * @param blockGID Global ID of the velocity block.
+ * @param blockLIDs Local IDs of the velocity block in each source neighbor.
  * @param values Vector where loaded data is stored.
  * @param cellid_transpose
  * @param popID ID of the particle species.
  */
 inline void copy_trans_block_data(
         SpatialCell** source_neighbors,
-        const vmesh::GlobalID blockGID,
+        const vmesh::LocalID* blockLIDs,
         Vec* values,
         const unsigned char* const cellid_transpose,
         const int& popID) {
@@ -367,7 +435,7 @@ inline void copy_trans_block_data(
     //  Copy volume averages of this block from all spatial cells:
     for (int b = -VLASOV_STENCIL_WIDTH; b <= VLASOV_STENCIL_WIDTH; ++b) {
         SpatialCell* srcCell = source_neighbors[b + VLASOV_STENCIL_WIDTH];
-        const vmesh::LocalID blockLID = srcCell->get_velocity_block_local_id(blockGID,popID);
+        const vmesh::LocalID blockLID = blockLIDs[b + VLASOV_STENCIL_WIDTH];
         if (blockLID != srcCell->invalid_local_id()) {
             Realv blockValues[WID3];
             const Realf* block_data = srcCell->get_data(blockLID,popID);
@@ -414,12 +482,12 @@ inline void copy_trans_block_data(
   j -> k
   k -> j
  * @param target_neighbors
- * @param blockGID Global ID of the target velocity block.
+ * @param blockLIDs Local IDs of the target velocity block in each target neighbor.
  * @param cellid_transpose
  * @param popID ID of the propagated particle species.*/
 inline void store_trans_block_data(
         SpatialCell** target_neighbors,
-        const vmesh::GlobalID blockGID,
+        const vmesh::LocalID* blockLIDs,
         Vec* __restrict__ target_values,
         const unsigned char* const cellid_transpose,
         const int& popID) {
@@ -430,7 +498,7 @@ inline void store_trans_block_data(
             continue; //do not store to boundary cells or otherwise invalid cells
         }
         SpatialCell* spatial_cell = target_neighbors[b + 1];
-        const vmesh::LocalID blockLID = spatial_cell->get_velocity_block_local_id(blockGID,popID);
+        const vmesh::LocalID blockLID = blockLIDs[b + 1];
         if (blockLID == vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>::invalidLocalID()) {
             // block does not exist. If so, we do not create it and add stuff to it here.
             // We have already created blocks around blocks with content in
@@ -476,7 +544,7 @@ bool trans_map_1d(
     
     // values used with an stencil in 1 dimension, initialized to 0. 
     // Contains a block, and its spatial neighbours in one dimension.
-    Realv dz,z_min, dvz,vz_min;
+    Realv dz,z_min;
     SpatialCell* spatial_cell = mpiGrid[cellID];
     uint block_indices_to_id[3]; /*< used when computing id of target block */
     uint cell_indices_to_id[3]; /*< used when computing id of target cell in block*/
@@ -507,8 +575,6 @@ bool trans_map_1d(
     vmesh::VelocityMesh<vmesh::GlobalID,vmesh::LocalID>& vmesh = mpiGrid[cellID]->get_velocity_mesh(popID);
 
     // set cell size in dimension direction
-    dvz = vmesh.getCellSize(REFLEVEL)[dimension];
-    vz_min = vmesh.getMeshMinLimits()[dimension];
     switch (dimension) {
         case 0:
             dz = P::dx_ini;
@@ -576,11 +642,36 @@ bool trans_map_1d(
 
     const Realv i_dz=1.0/dz;
 
+    // Blocks are visited in GID order, so that their local IDs in the
+    // neighbor cells are found by walking the sorted block lists of the
+    // neighbors forward (a merge) instead of by hash lookups.
+    const vector<pair<vmesh::GlobalID,vmesh::LocalID> >& sorted_blocks = spatial_cell->sorted_velocity_block_list;
+    size_t source_positions[1 + 2 * VLASOV_STENCIL_WIDTH];
+    size_t target_positions[3];
+    for (uint i = 0; i < 1 + 2 * VLASOV_STENCIL_WIDTH; ++i) source_positions[i] = sorted_blocks.size();
+    for (uint i = 0; i < 3; ++i) target_positions[i] = sorted_blocks.size();
+
     // Loop over blocks in spatial cell. In ordinary space the number of
     // blocks in this spatial cell does not change.
     #pragma omp for
-    for (vmesh::LocalID block_i=0; block_i<vmesh.size(); ++block_i) {
-        const vmesh::GlobalID blockGID = vmesh.getGlobalID(block_i);
+    for (vmesh::LocalID block_i=0; block_i<sorted_blocks.size(); ++block_i) {
+        const vmesh::GlobalID blockGID = sorted_blocks[block_i].first;
+        const vmesh::LocalID blockLID = sorted_blocks[block_i].second;
+
+        // local IDs of this block in source and target neighbors
+        vmesh::LocalID source_block_lids[1 + 2 * VLASOV_STENCIL_WIDTH];
+        vmesh::LocalID target_block_lids[3];
+        for (uint i = 0; i < 1 + 2 * VLASOV_STENCIL_WIDTH; ++i) {
+            if (source_neighbors[i] == spatial_cell) source_block_lids[i] = blockLID;
+            else source_block_lids[i] = find_sorted_block_local_id(source_neighbors[i]->sorted_velocity_block_list,
+                                                                   source_positions[i],blockGID);
+        }
+        for (uint i = 0; i < 3; ++i) {
+            if (target_neighbors[i] == NULL) target_block_lids[i] = SpatialCell::invalid_local_id();
+            else if (target_neighbors[i] == spatial_cell) target_block_lids[i] = blockLID;
+            else target_block_lids[i] = find_sorted_block_local_id(target_neighbors[i]->sorted_velocity_block_list,
+                                                                   target_positions[i],blockGID);
+        }
 
         // Each thread only computes a certain non-overlapping subset of blocks
         //if (blockGID % num_threads != thread_id) continue;
@@ -595,17 +686,20 @@ bool trans_map_1d(
 
         // buffer where we read in source data. i index vectorized
         Vec values[(1 + 2 * VLASOV_STENCIL_WIDTH) * WID3 / VECL];
-        copy_trans_block_data(source_neighbors, blockGID, values, cellid_transpose,popID);
-        velocity_block_indices_t block_indices;
-        uint8_t refLevel;
-        vmesh.getIndices(blockGID,refLevel,block_indices[0],block_indices[1],block_indices[2]);
+        copy_trans_block_data(source_neighbors, source_block_lids, values, cellid_transpose,popID);
+        // lower corner and cell size of the block, cell sizes are not 
+        // uniform across blocks in stretched velocity meshes
+        Real blockInfo[6];
+        vmesh.getBlockInfo(blockGID,blockInfo);
+        const Realv block_vz_min = blockInfo[dimension];
+        const Realv block_dvz = blockInfo[3+dimension];
 
         //i,j,k are now relative to the order in which we copied data to the values array. 
         //After this point in the k,j,i loops there should be no branches based on dimensions
         //
         //Note that the i dimension is vectorized, and thus there are no loops over i
         for (uint k=0; k<WID; ++k) {
-            const Realv cell_vz = (block_indices[dimension] * WID + k + 0.5) * dvz + vz_min; //cell centered velocity
+            const Realv cell_vz = block_vz_min + (k + 0.5) * block_dvz; //cell centered velocity
             const Realv z_translation = cell_vz * dt * i_dz; // how much it moved in time dt (reduced units)
             const int target_scell_index = (z_translation > 0) ? 1: -1; //part of density goes here (cell index change along spatial direcion)
          
@@ -659,7 +753,7 @@ bool trans_map_1d(
         }
       
         //store values from target_values array to the actual blocks
-        store_trans_block_data(target_neighbors,blockGID,target_values,cellid_transpose,popID);
+        store_trans_block_data(target_neighbors,target_block_lids,target_values,cellid_transpose,popID);
     }
 
     return true;
@@ -42,6 +42,7 @@
 #include "cpu_moments.h"
 #include "cpu_acc_semilag.hpp"
 #include "cpu_trans_map.hpp"
+#include "../mpi_progress.h"
 
 using namespace std;
 using namespace spatial_cell;
@@ -54,6 +55,39 @@ creal ONE     = 1.0;
 creal TWO     = 2.0;
 creal EPSILON = 1.0e-25;
 
+/** Map the distribution function of the given cells along one dimension.
+ * Cells are processed one at a time, the threads share the velocity blocks
+ * of each cell.
+ * @param mpiGrid Parallel grid.
+ * @param cells Spatial cells that are mapped.
+ * @param dimension Dimension along which the cells are mapped.
+ * @param dt Timestep.
+ * @param popID ID of the translated particle species.*/
+void translateCells(
+        dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
+        const vector<CellID>& cells,
+        const uint dimension,
+        creal dt,
+        const int& popID) {
+   #pragma omp parallel
+   {
+      const int tid = omp_get_thread_num();
+      no_subnormals();
+      for (size_t c=0; c<cells.size(); ++c) {
+         Real t_start = 0;
+         if (tid == 0) if (Parameters::prepareForRebalance == true) t_start = MPI_Wtime();
+
+         trans_map_1d(mpiGrid,cells[c],dimension,dt,popID);
+
+         if (tid == 0) if (Parameters::prepareForRebalance == true) {
+            mpiGrid[cells[c]]->get_cell_parameters()[CellParams::LBWEIGHTCOUNTER] 
+                    += (MPI_Wtime()-t_start);
+         }
+         mpiprogress::poll();
+      }
+   }
+}
+
 /** Propagates the distribution function in spatial space. 
     
     Based on SLICE-3D algorithm: Zerroukat, M., and T. Allen. "A
@@ -65,17 +99,24 @@ creal EPSILON = 1.0e-25;
 void calculateSpatialTranslation(
         dccrg::Dccrg<SpatialCell,dccrg::Cartesian_Geometry>& mpiGrid,
         const vector<CellID>& localCells,
-        const vector<CellID>& local_propagated_cells,
+        const vector<CellID> local_propagated_inner_cells[3],
+        const vector<CellID> local_propagated_boundary_cells[3],
         const vector<CellID>& local_target_cells,
         const vector<CellID>& remoteTargetCellsx,
         const vector<CellID>& remoteTargetCellsy,
         const vector<CellID>& remoteTargetCellsz,
+        const vector<CellID>& remoteStencilCells,
         creal dt,
         const int& popID) {
 
     int trans_timer;
     bool localTargetGridGenerated = false;
 
+    // Block lists sorted by global ID, used to find blocks in neighbor cells.
+    // Meshes do not change during translation, so these are shared by all dimensions.
+    createSortedBlockLists(mpiGrid,localCells,popID);
+    createSortedBlockLists(mpiGrid,remoteStencilCells,popID);
+
     // ------------- SLICE - map dist function in Z --------------- //
    if(P::zcells_ini > 1 ){
       trans_timer=phiprof::initializeTimer("transfer-stencil-data-z","MPI");
@@ -83,6 +124,7 @@ void calculateSpatialTranslation(
       SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_DATA);
       mpiGrid.start_remote_neighbor_copy_updates(VLASOV_SOLVER_Z_NEIGHBORHOOD_ID);
       phiprof::stop(trans_timer);
+      mpiprogress::exchangeStarted();
       
       // generate target grid in the temporary arrays, same size as
       // original one. We only need to create these in target cells
@@ -93,27 +135,20 @@ void calculateSpatialTranslation(
          localTargetGridGenerated=true;
       }
 
+      // Cells whose stencil is local are mapped while the stencil data 
+      // of the process boundary cells is in transit
+      phiprof::start("compute-mapping-z");
+      translateCells(mpiGrid,local_propagated_inner_cells[2],2,dt,popID);
+      phiprof::stop("compute-mapping-z");
+
+      mpiprogress::waitStarted();
       phiprof::start(trans_timer);
       mpiGrid.wait_remote_neighbor_copy_update_receives(VLASOV_SOLVER_Z_NEIGHBORHOOD_ID);
       phiprof::stop(trans_timer);
+      mpiprogress::waitFinished();
       
       phiprof::start("compute-mapping-z");
-      #pragma omp parallel
-      {
-         const int tid = omp_get_thread_num();
-         no_subnormals();
-         for (size_t c=0; c<local_propagated_cells.size(); ++c) {
-            Real t_start = 0;
-            if (tid == 0) if (Parameters::prepareForRebalance == true) t_start = MPI_Wtime();
-
-            trans_map_1d(mpiGrid,local_propagated_cells[c], 2, dt,popID); // map along z//
-
-            if (tid == 0) if (Parameters::prepareForRebalance == true) {
-               mpiGrid[local_propagated_cells[c]]->get_cell_parameters()[CellParams::LBWEIGHTCOUNTER] 
-                       += (MPI_Wtime()-t_start);
-            }
-         }
-      }
+      translateCells(mpiGrid,local_propagated_boundary_cells[2],2,dt,popID);
       phiprof::stop("compute-mapping-z");
 
       phiprof::start(trans_timer);
@@ -126,7 +161,6 @@ void calculateSpatialTranslation(
       update_remote_mapping_contribution(mpiGrid, 2,-1,popID);
       phiprof::stop("update_remote-z");
 
-      clearTargetGrid(mpiGrid,remoteTargetCellsz);
       swapTargetSourceGrid(mpiGrid, local_target_cells,popID);
       zeroTargetGrid(mpiGrid, local_target_cells);
    }
@@ -138,6 +172,7 @@ void calculateSpatialTranslation(
       SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_DATA);
       mpiGrid.start_remote_neighbor_copy_updates(VLASOV_SOLVER_X_NEIGHBORHOOD_ID);
       phiprof::stop(trans_timer);
+      mpiprogress::exchangeStarted();
       
       createTargetGrid(mpiGrid,remoteTargetCellsx,popID);
        if(!localTargetGridGenerated){ 
@@ -145,27 +180,20 @@ void calculateSpatialTranslation(
          localTargetGridGenerated=true;
       }
 
+      // Cells whose stencil is local are mapped while the stencil data 
+      // of the process boundary cells is in transit
+      phiprof::start("compute-mapping-x");
+      translateCells(mpiGrid,local_propagated_inner_cells[0],0,dt,popID);
+      phiprof::stop("compute-mapping-x");
+
+      mpiprogress::waitStarted();
       phiprof::start(trans_timer);
       mpiGrid.wait_remote_neighbor_copy_update_receives(VLASOV_SOLVER_X_NEIGHBORHOOD_ID);
       phiprof::stop(trans_timer);
+      mpiprogress::waitFinished();
 
       phiprof::start("compute-mapping-x");
-      #pragma omp parallel
-      {
-         const int tid = omp_get_thread_num();
-         no_subnormals();
-         for (size_t c=0; c<local_propagated_cells.size(); ++c) {
-            Real t_start = 0;
-            if (tid == 0) if (Parameters::prepareForRebalance == true) t_start = MPI_Wtime();
-
-            trans_map_1d(mpiGrid,local_propagated_cells[c],0,dt,popID); // map along x//
-
-            if (tid == 0) if (Parameters::prepareForRebalance == true) {
-               mpiGrid[local_propagated_cells[c]]->get_cell_parameters()[CellParams::LBWEIGHTCOUNTER] 
-                       += (MPI_Wtime()-t_start);
-            }
-         }
-      }
+      translateCells(mpiGrid,local_propagated_boundary_cells[0],0,dt,popID);
       phiprof::stop("compute-mapping-x");
 
       phiprof::start(trans_timer);
@@ -177,7 +205,6 @@ void calculateSpatialTranslation(
       update_remote_mapping_contribution(mpiGrid, 0,+1,popID);
       update_remote_mapping_contribution(mpiGrid, 0,-1,popID);
       phiprof::stop("update_remote-x");
-      clearTargetGrid(mpiGrid,remoteTargetCellsx);
       swapTargetSourceGrid(mpiGrid, local_target_cells,popID);
       zeroTargetGrid(mpiGrid, local_target_cells);
    }
@@ -189,6 +216,7 @@ void calculateSpatialTranslation(
       SpatialCell::set_mpi_transfer_type(Transfer::VEL_BLOCK_DATA);
       mpiGrid.start_remote_neighbor_copy_updates(VLASOV_SOLVER_Y_NEIGHBORHOOD_ID);
       phiprof::stop(trans_timer);
+      mpiprogress::exchangeStarted();
       
       createTargetGrid(mpiGrid,remoteTargetCellsy,popID);
       if(!localTargetGridGenerated){ 
@@ -196,27 +224,20 @@ void calculateSpatialTranslation(
          localTargetGridGenerated=true;
       }
       
+      // Cells whose stencil is local are mapped while the stencil data 
+      // of the process boundary cells is in transit
+      phiprof::start("compute-mapping-y");
+      translateCells(mpiGrid,local_propagated_inner_cells[1],1,dt,popID);
+      phiprof::stop("compute-mapping-y");
+
+      mpiprogress::waitStarted();
       phiprof::start(trans_timer);
       mpiGrid.wait_remote_neighbor_copy_update_receives(VLASOV_SOLVER_Y_NEIGHBORHOOD_ID);
       phiprof::stop(trans_timer);
+      mpiprogress::waitFinished();
 
       phiprof::start("compute-mapping-y");
-      #pragma omp parallel
-      {
-         const int tid = omp_get_thread_num();
-         no_subnormals();
-         for (size_t c=0; c<local_propagated_cells.size(); ++c) {
-            Real t_start = 0;
-            if (tid == 0) if (Parameters::prepareForRebalance == true) t_start = MPI_Wtime();
-            
-            trans_map_1d(mpiGrid,local_propagated_cells[c],1,dt,popID); // map along y//
-            
-            if (tid == 0) if (Parameters::prepareForRebalance == true) {
-               mpiGrid[local_propagated_cells[c]]->get_cell_parameters()[CellParams::LBWEIGHTCOUNTER] 
-                       += (MPI_Wtime()-t_start);
-            }
-         }
-      }
+      translateCells(mpiGrid,local_propagated_boundary_cells[1],1,dt,popID);
       phiprof::stop("compute-mapping-y");
 
       phiprof::start(trans_timer);
@@ -228,11 +249,13 @@ void calculateSpatialTranslation(
       update_remote_mapping_contribution(mpiGrid, 1,+1,popID);
       update_remote_mapping_contribution(mpiGrid, 1,-1,popID);
       phiprof::stop("update_remote-y");
-      clearTargetGrid(mpiGrid,remoteTargetCellsy);
       swapTargetSourceGrid(mpiGrid, local_target_cells,popID);
    }
 
-   clearTargetGrid(mpiGrid,local_target_cells);
+   // Temporary target grids are kept allocated, the next translation
+   // (or the next population) reuses them.
+   clearSortedBlockLists(mpiGrid,localCells);
+   clearSortedBlockLists(mpiGrid,remoteStencilCells);
 }
 
 /*!
@@ -256,7 +279,9 @@ void calculateSpatialTranslation(
    vector<CellID> remoteTargetCellsx;
    vector<CellID> remoteTargetCellsy;
    vector<CellID> remoteTargetCellsz;
-   vector<CellID> local_propagated_cells;
+   vector<CellID> remoteStencilCells;
+   vector<CellID> local_propagated_inner_cells[3];
+   vector<CellID> local_propagated_boundary_cells[3];
    vector<CellID> local_target_cells;
    
    // If dt=0 we are either initializing or distribution functions are not translated. 
@@ -267,12 +292,26 @@ void calculateSpatialTranslation(
     remoteTargetCellsx = mpiGrid.get_remote_cells_on_process_boundary(VLASOV_SOLVER_TARGET_X_NEIGHBORHOOD_ID);
     remoteTargetCellsy = mpiGrid.get_remote_cells_on_process_boundary(VLASOV_SOLVER_TARGET_Y_NEIGHBORHOOD_ID);
     remoteTargetCellsz = mpiGrid.get_remote_cells_on_process_boundary(VLASOV_SOLVER_TARGET_Z_NEIGHBORHOOD_ID);
+    remoteStencilCells = mpiGrid.get_remote_cells_on_process_boundary(VLASOV_SOLVER_NEIGHBORHOOD_ID);
 
     // Figure out which spatial cells are translated, 
-    // result independent of particle species.
-    for (size_t c=0; c<localCells.size(); ++c) {
-       if (do_translate_cell(mpiGrid[localCells[c]])) {
-          local_propagated_cells.push_back(localCells[c]);
+    // result independent of particle species. In each dimension the 
+    // cells are split into those whose stencil is local, and those 
+    // that need data from other processes.
+    for (int dimension=0; dimension<3; ++dimension) {
+       const vector<CellID> innerCells 
+          = mpiGrid.get_local_cells_not_on_process_boundary(VLASOV_SOLVER_X_NEIGHBORHOOD_ID+dimension);
+       const vector<CellID> boundaryCells 
+          = mpiGrid.get_local_cells_on_process_boundary(VLASOV_SOLVER_X_NEIGHBORHOOD_ID+dimension);
+       for (size_t c=0; c<innerCells.size(); ++c) {
+          if (do_translate_cell(mpiGrid[innerCells[c]])) {
+             local_propagated_inner_cells[dimension].push_back(innerCells[c]);
+          }
+       }
+       for (size_t c=0; c<boundaryCells.size(); ++c) {
+          if (do_translate_cell(mpiGrid[boundaryCells[c]])) {
+             local_propagated_boundary_cells[dimension].push_back(boundaryCells[c]);
+          }
        }
     }
 
@@ -290,9 +329,9 @@ void calculateSpatialTranslation(
       string profName = "translate "+getObjectWrapper().particleSpecies[popID].name;
       phiprof::start(profName);
       SpatialCell::setCommunicatedSpecies(popID);
-      calculateSpatialTranslation(mpiGrid,localCells,local_propagated_cells,
-                                  local_target_cells,remoteTargetCellsx,remoteTargetCellsy,
-                                  remoteTargetCellsz,dt,popID);
+      calculateSpatialTranslation(mpiGrid,localCells,local_propagated_inner_cells,
+                                  local_propagated_boundary_cells,local_target_cells,remoteTargetCellsx,remoteTargetCellsy,
+                                  remoteTargetCellsz,remoteStencilCells,dt,popID);
       phiprof::stop(profName);
    }
 